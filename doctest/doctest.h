@@ -180,9 +180,31 @@ typedef basic_ostream<char, char_traits<char> > ostream;
 
 namespace doctest
 {
+// short strings are stored inline and longer ones on the heap (with their length and capacity).
+// The last byte of the inline buffer tells which - for inline strings it holds how many more
+// characters would fit (so it is also the '\0' terminator of a full buffer) and for strings on
+// the heap its high bit is set
 class String
 {
-    char* m_str;
+    static const unsigned len  = 24;      // the size of the inline buffer
+    static const unsigned last = len - 1; // the index of the byte with the flags
+
+    struct view // should be smaller than the inline buffer - so the last byte stays free
+    {
+        char*    ptr;
+        unsigned size;
+        unsigned capacity;
+    };
+
+    union
+    {
+        char buf[len];
+        view data;
+    };
+
+    bool isOnStack() const { return (buf[last] & 128) == 0; }
+    void setOnHeap() { *reinterpret_cast<unsigned char*>(&buf[last]) = 128; }
+    void setLast(unsigned in = last) { buf[last] = static_cast<char>(in); }
 
     void copy(const String& other);
 
@@ -196,11 +218,11 @@ public:
     String operator+(const String& other) const;
     String& operator+=(const String& other);
 
-    char& operator[](unsigned pos) { return m_str[pos]; }
-    const char& operator[](unsigned pos) const { return m_str[pos]; }
+    char& operator[](unsigned pos) { return c_str()[pos]; }
+    const char& operator[](unsigned pos) const { return c_str()[pos]; }
 
-    char*       c_str() { return m_str; }
-    const char* c_str() const { return m_str; }
+    char*       c_str() { return isOnStack() ? buf : data.ptr; }
+    const char* c_str() const { return isOnStack() ? buf : data.ptr; }
 
     unsigned size() const;
     unsigned length() const;
@@ -414,6 +436,33 @@ inline String toString<Approx>(Approx const& value) {
     return value.toString();
 }
 
+namespace detail
+{
+    // defined in the implementation translation unit so the compiler can't see that it does nothing
+    void useCharPointer(const volatile char*);
+} // namespace detail
+
+// for benchmarks - makes the compiler assume that the value is read so computing it can't be
+// optimized away (or moved out of the loop of the benchmark)
+template <typename T>
+void doNotOptimize(const T& value) {
+#if defined(__GNUC__)
+    __asm__ __volatile__("" : : "r,m"(value) : "memory");
+#else  // __GNUC__
+    detail::useCharPointer(&reinterpret_cast<const volatile char&>(value));
+#endif // __GNUC__
+}
+
+// for benchmarks - makes the compiler assume that all memory is read and written so writes to
+// memory can't be optimized away
+inline void clobberMemory() {
+#if defined(__GNUC__)
+    __asm__ __volatile__("" : : : "memory");
+#else  // __GNUC__
+    detail::useCharPointer(0);
+#endif // __GNUC__
+}
+
 #if !defined(DOCTEST_CONFIG_DISABLE)
 
 namespace detail
@@ -447,11 +496,12 @@ namespace detail
     bool  always_false();
     void* getNullPtr();
 
-    // a struct defining a registered test callback
+    // a struct defining a registered test callback. It is an aggregate so each test has one
+    // statically initialized instance - registering a test only links it in an intrusive list
     struct TestData
     {
         // not used for determining uniqueness
-        const char* m_suite; // the test suite in which the test was added
+        const char* m_suite; // the test suite in which the test was added (set when registered)
         const char* m_name;  // name of the test function
         funcType    m_f;     // a function pointer to the test function
 
@@ -459,12 +509,10 @@ namespace detail
         const char* m_file; // the file in which the test was registered
         unsigned    m_line; // the line where the test was registered
 
-        TestData(const char* suite, const char* name, funcType f, const char* file, int line)
-                : m_suite(suite)
-                , m_name(name)
-                , m_f(f)
-                , m_file(file)
-                , m_line(line) {}
+        // the time limit in seconds - 0 for the one from --dt-timeout and negative for none
+        double m_timeout;
+
+        TestData* m_next; // the next registered test (set when registered)
 
         bool operator==(const TestData& other) const;
     };
@@ -481,10 +529,87 @@ namespace detail
         Subcase(const Subcase& other);
         Subcase& operator=(const Subcase& other);
 
-        bool operator==(const Subcase& other) const;
         operator bool() const { return m_entered; }
     };
 
+    // the state of a BENCHMARK - its body is the body of a loop which runs while keepRunning()
+    // returns true. First the number of iterations for a sample is calibrated (so a sample takes
+    // at least --dt-benchmark-time), then a sample is executed for warmup and then the samples
+    // which are measured - the results are reported after the last one
+    struct PerfCounters;
+
+    struct Benchmark
+    {
+        const char* m_name;
+        const char* m_file;
+        int         m_line;
+        int         m_phase;
+        unsigned    m_left;       // iterations left in the current batch
+        unsigned    m_iterations; // in a batch
+        double      m_batchStart;
+        double      m_sampleTime; // the target duration of a sample in seconds
+        unsigned    m_numSamples;
+        unsigned    m_numMeasured;
+        double*     m_samples; // the duration of an iteration for each measured sample
+
+        PerfCounters* m_perfCounters; // for the measured samples (only with --dt-perf-counters)
+
+        Benchmark(const char* name, const char* file, int line);
+        ~Benchmark();
+
+        // the only thing executed for each iteration (except the body)
+        bool keepRunning() {
+            if(m_left == 0)
+                return nextBatch();
+            --m_left;
+            return true;
+        }
+
+        bool nextBatch();
+
+    private:
+        Benchmark(const Benchmark&);
+        Benchmark& operator=(const Benchmark&);
+    };
+
+    // the state of CHECK_MAX_ALLOCATIONS and the others - the body is the body of a loop which is
+    // executed once and the allocations during it are checked when once() is called after it
+    struct AllocationCheck
+    {
+        const char* m_assertName;
+        const char* m_expr;
+        const char* m_file;
+        int         m_line;
+        unsigned    m_max;
+        unsigned    m_numBefore; // the number of allocations of the test before the body
+        bool        m_done;
+
+        AllocationCheck(unsigned max, const char* assert_name, const char* expr, const char* file,
+                        int line);
+
+        bool once();
+    };
+
+    struct TestAccessibleContextState
+    {
+        bool            success;   // include successful assertions in output
+        bool            no_throw;  // to skip exceptions-related assertion macros
+        bool            no_breaks; // to not break into the debugger
+        const TestData* currentTest;
+        int             numAssertionsForCurrentTestcase;
+        const char*     lastAssertFile; // the last assert reached - reported if the test crashes
+        int             lastAssertLine;
+
+        void setLastAssert(const char* file, int line) {
+            lastAssertFile = file;
+            lastAssertLine = line;
+        }
+    };
+
+    struct ContextState;
+
+    TestAccessibleContextState* getTestsContextState();
+
     template <typename L, typename R>
     String stringifyBinaryExpr(const L& lhs, const char* op, const R& rhs) {
         return toString(lhs) + " " + op + " " + toString(rhs);
@@ -523,8 +648,6 @@ namespace detail
 
         operator bool() { return !m_passed; }
 
-        void invert() { m_passed = !m_passed; }
-
         // clang-format off
         //template <typename R> STATIC_ASSERT_Expression_Too_Complex_Please_Rewrite_As_Binary_Comparison& operator+(const R&);
         //template <typename R> STATIC_ASSERT_Expression_Too_Complex_Please_Rewrite_As_Binary_Comparison& operator-(const R&);
@@ -576,48 +699,68 @@ namespace detail
 
     // clang-format on
 
+    // the operands are stringified only when needed - if the assert fails or passing ones are logged
     template <typename L>
     struct Expression_lhs
     {
-        L lhs;
+        L    lhs;
+        bool is_false; // if the result should be inverted (for the *_FALSE asserts)
 
-        Expression_lhs(L in)
-                : lhs(in) {}
+        Expression_lhs(L in, bool in_is_false)
+                : lhs(in)
+                , is_false(in_is_false) {}
 
         Expression_lhs(const Expression_lhs& other)
-                : lhs(other.lhs) {}
+                : lhs(other.lhs)
+                , is_false(other.is_false) {}
+
+        operator Result() {
+            bool res = !!lhs;
+            if(is_false)
+                res = !res;
+            if(!res || getTestsContextState()->success)
+                return Result(res, toString(lhs));
+            return Result(res);
+        }
 
-        operator Result() { return Result(!!lhs, toString(lhs)); }
+        template <typename R>
+        Result binaryResult(bool res, const char* op, const R& rhs) {
+            if(is_false)
+                res = !res;
+            if(!res || getTestsContextState()->success)
+                return Result(res, stringifyBinaryExpr(lhs, op, rhs));
+            return Result(res);
+        }
 
         // clang-format off
-        template <typename R> Result operator==(const R& rhs) { return Result(eq (lhs, rhs), stringifyBinaryExpr(lhs, "==", rhs)); }
-        template <typename R> Result operator!=(const R& rhs) { return Result(neq(lhs, rhs), stringifyBinaryExpr(lhs, "!=", rhs)); }
-        template <typename R> Result operator< (const R& rhs) { return Result(lt (lhs, rhs), stringifyBinaryExpr(lhs, "<" , rhs)); }
-        template <typename R> Result operator<=(const R& rhs) { return Result(lte(lhs, rhs), stringifyBinaryExpr(lhs, "<=", rhs)); }
-        template <typename R> Result operator> (const R& rhs) { return Result(gt (lhs, rhs), stringifyBinaryExpr(lhs, ">" , rhs)); }
-        template <typename R> Result operator>=(const R& rhs) { return Result(gte(lhs, rhs), stringifyBinaryExpr(lhs, ">=", rhs)); }
+        template <typename R> Result operator==(const R& rhs) { return binaryResult(eq (lhs, rhs), "==", rhs); }
+        template <typename R> Result operator!=(const R& rhs) { return binaryResult(neq(lhs, rhs), "!=", rhs); }
+        template <typename R> Result operator< (const R& rhs) { return binaryResult(lt (lhs, rhs), "<" , rhs); }
+        template <typename R> Result operator<=(const R& rhs) { return binaryResult(lte(lhs, rhs), "<=", rhs); }
+        template <typename R> Result operator> (const R& rhs) { return binaryResult(gt (lhs, rhs), ">" , rhs); }
+        template <typename R> Result operator>=(const R& rhs) { return binaryResult(gte(lhs, rhs), ">=", rhs); }
         // clang-format on
     };
 
     struct ExpressionDecomposer
     {
+        bool is_false;
+
+        explicit ExpressionDecomposer(bool in_is_false)
+                : is_false(in_is_false) {}
+
         template <typename L>
         Expression_lhs<const L&> operator<<(const L& operand) {
-            return Expression_lhs<const L&>(operand);
+            return Expression_lhs<const L&>(operand, is_false);
         }
     };
 
     // forward declarations of functions used by the macros
-    int regTest(void (*f)(void), unsigned line, const char* file, const char* name);
+    int regTest(TestData* data);
     int setTestSuiteName(const char* name);
 
     void addFailedAssert(const char* assert_name);
 
-    void logTestStart(const char* name, const char* file, unsigned line);
-    void logTestEnd();
-
-    void logTestCrashed();
-
     void logAssert(bool passed, const char* decomposition, bool threw, const char* expr,
                    const char* assert_name, const char* file, int line);
 
@@ -633,23 +776,198 @@ namespace detail
     bool isDebuggerActive();
     void writeToDebugConsole(const String&);
 
-    struct TestAccessibleContextState
+    // logs an assert from the binary/unary families (CHECK_EQ, CHECK_UNARY, etc.) if it failed or
+    // if passing ones are logged and counts it - returns true if it failed (the caller reacts)
+    bool logBinaryAssert(bool passed, const String& decomposition, bool threw, const char* expr,
+                         const char* assert_name, const char* file, int line);
+
+    // the comparisons used by the binary asserts
+    namespace binaryAssertComparison
     {
-        bool            success;   // include successful assertions in output
-        bool            no_throw;  // to skip exceptions-related assertion macros
-        bool            no_breaks; // to not break into the debugger
-        const TestData* currentTest;
-        bool            hasLoggedCurrentTestStart;
-        int             numAssertionsForCurrentTestcase;
-    };
+        enum Enum
+        {
+            eq = 0,
+            ne,
+            gt,
+            lt,
+            ge,
+            le
+        };
+    } // namespace binaryAssertComparison
 
-    struct ContextState;
+    // clang-format off
+    template <int, class L, class R> struct RelationalComparator     { bool operator()(const L&,     const R&    ) const { return false;        } };
+    template <class L, class R> struct RelationalComparator<0, L, R> { bool operator()(const L& lhs, const R& rhs) const { return eq(lhs, rhs);  } };
+    template <class L, class R> struct RelationalComparator<1, L, R> { bool operator()(const L& lhs, const R& rhs) const { return neq(lhs, rhs); } };
+    template <class L, class R> struct RelationalComparator<2, L, R> { bool operator()(const L& lhs, const R& rhs) const { return gt(lhs, rhs);  } };
+    template <class L, class R> struct RelationalComparator<3, L, R> { bool operator()(const L& lhs, const R& rhs) const { return lt(lhs, rhs);  } };
+    template <class L, class R> struct RelationalComparator<4, L, R> { bool operator()(const L& lhs, const R& rhs) const { return gte(lhs, rhs); } };
+    template <class L, class R> struct RelationalComparator<5, L, R> { bool operator()(const L& lhs, const R& rhs) const { return lte(lhs, rhs); } };
+    // clang-format on
 
-    TestAccessibleContextState* getTestsContextState();
+    // compares the operands directly - they are stringified only if the assert has to be logged
+    template <int comparison, typename L, typename R>
+    bool binaryAssert(const char* assert_name, const char* file, int line, const char* expr,
+                      const L& lhs, const R& rhs) {
+        TestAccessibleContextState* s = getTestsContextState();
+        s->setLastAssert(file, line);
+        bool passed = RelationalComparator<comparison, L, R>()(lhs, rhs);
+        if(passed && !s->success) {
+            s->numAssertionsForCurrentTestcase++;
+            return false;
+        }
+        return logBinaryAssert(passed, toString(lhs) + ", " + toString(rhs), false, expr,
+                               assert_name, file, line);
+    }
+
+    template <bool is_false, typename L>
+    bool unaryAssert(const char* assert_name, const char* file, int line, const char* expr,
+                     const L& val) {
+        TestAccessibleContextState* s = getTestsContextState();
+        s->setLastAssert(file, line);
+        bool passed = is_false ? !val : !!val;
+        if(passed && !s->success) {
+            s->numAssertionsForCurrentTestcase++;
+            return false;
+        }
+        return logBinaryAssert(passed, toString(val), false, expr, assert_name, file, line);
+    }
 } // namespace detail
 
 #endif // DOCTEST_CONFIG_DISABLE
 
+// the data of a test case - as passed to reporters
+struct TestCaseData
+{
+    const char* m_file;  // the file in which the test was registered
+    unsigned    m_line;  // the line where the test was registered
+    const char* m_name;  // name of the test case
+    const char* m_suite; // the test suite in which the test was added
+};
+
+// the data of a subcase - as passed to reporters
+struct SubcaseData
+{
+    const char* m_name;
+    const char* m_file;
+    int         m_line;
+};
+
+// the data of a logged assert - failed asserts are always logged and passed ones only with -s
+struct AssertData
+{
+    // the families of asserts - they differ in what is known about them
+    enum Kind
+    {
+        Normal = 0, // CHECK, CHECK_FALSE, CHECK_EQ, CHECK_UNARY, etc.
+        Throws,     // CHECK_THROWS
+        ThrowsAs,   // CHECK_THROWS_AS
+        Nothrow     // CHECK_NOTHROW
+    };
+
+    Kind        m_kind;
+    bool        m_passed;
+    const char* m_assertName; // CHECK, REQUIRE_EQ, etc.
+    const char* m_file;
+    int         m_line;
+    const char* m_expr; // the expression as written in the source
+
+    bool        m_threw;         // if an exception was thrown
+    bool        m_threwAs;       // for ThrowsAs - if the exception was of the expected type
+    const char* m_exceptionType; // for ThrowsAs - the expected type
+    const char* m_decomposition; // for Normal - the values of the operands ("" if it threw)
+};
+
+// the events which can be counted for test cases and benchmarks with --dt-perf-counters (only on
+// Linux - with perf_event_open)
+namespace perfCounter
+{
+    enum Enum
+    {
+        cycles = 0,
+        instructions,
+        cacheReferences,
+        cacheMisses,
+        branches,
+        branchMisses,
+        pageFaults,
+        contextSwitches,
+
+        count // the number of events
+    };
+} // namespace perfCounter
+
+// the results of a benchmark - the durations are of a single iteration (in seconds)
+struct BenchmarkData
+{
+    const char* m_name;
+    const char* m_file;
+    int         m_line;
+    unsigned    m_numSamples;
+    unsigned    m_iterations; // of the body for each sample
+    double      m_mean;
+    double      m_median;
+    double      m_stddev;
+    double      m_min;
+
+    // the events of an iteration with --dt-perf-counters (negative for the ones not counted)
+    double m_perfCounters[perfCounter::count];
+};
+
+// the totals of a test case - reported when it ends
+struct TestCaseStats
+{
+    bool   m_failed;
+    int    m_numAssertions;
+    int    m_numFailedAssertions;
+    double m_duration;    // wall clock time in seconds
+    double m_cpuDuration; // CPU time of the thread executing the test (only with --dt-durations)
+
+    // the allocations with operator new by the test (only with DOCTEST_CONFIG_TRACK_ALLOCATIONS)
+    unsigned      m_numAllocations;
+    unsigned long m_allocatedBytes;
+    unsigned long m_peakAllocatedBytes; // the most memory allocated by the test at the same time
+
+    // the events with --dt-perf-counters (negative for the ones not counted)
+    double m_perfCounters[perfCounter::count];
+};
+
+// the totals of a run
+struct RunStats
+{
+    unsigned m_numTestCases; // the number of tests passing the filters
+    unsigned m_numFailedTestCases;
+    int      m_numAssertions;
+    int      m_numFailedAssertions;
+};
+
+// the interface for reporters - they receive the events of a run and produce output from them.
+// The events of each test come in order but not necessarily from the thread executing the test
+// (with --dt-async-reporters, --dt-jobs and --dt-workers) - the data passed is valid only during
+// the call. Reporters can be added with Context::addReporter()
+struct IReporter
+{
+    virtual ~IReporter() {}
+
+    virtual void testCaseStart(const TestCaseData&) {}
+    // the test case is executed again for its subcases which haven't been entered yet
+    virtual void testCaseReenter(const TestCaseData&) {}
+    // for test cases with subcases - one execution of the test case (for a path of subcases) ended
+    virtual void testCaseIterationEnd(const TestCaseData&, const TestCaseStats&) {}
+    virtual void testCaseEnd(const TestCaseData&, const TestCaseStats&) {}
+    // the test case threw an exception out of its body (or its worker process died)
+    virtual void testCaseCrashed(const TestCaseData&, const char* /* reason */) {}
+
+    virtual void subcaseStart(const SubcaseData&) {}
+    virtual void subcaseEnd(const SubcaseData&) {}
+
+    virtual void logAssert(const AssertData&) {}
+
+    virtual void logBenchmark(const BenchmarkData&) {}
+
+    virtual void runEnd(const RunStats&) {}
+};
+
 class Context
 {
 #if !defined(DOCTEST_CONFIG_DISABLE)
@@ -672,6 +990,9 @@ public:
     void setOption(const char* option, int value);
     void setOption(const char* option, const char* value);
 
+    // the reporter is not owned - it should outlive the calls to run()
+    void addReporter(IReporter* reporter);
+
     bool shouldExit();
 
     int run();
@@ -682,25 +1003,33 @@ public:
 // if registering is not disabled
 #if !defined(DOCTEST_CONFIG_DISABLE)
 
-// registers the test by initializing a dummy var with a function
+// registers the test by initializing a dummy var with a function - the data for the test is
+// initialized statically (no code is executed for it) and is only linked in a list when registered
+#define DOCTEST_TEST_DATA(f, name, timeout)                                                        \
+    static doctest::detail::TestData DOCTEST_CONCAT(f, _DATA) = {                                  \
+            static_cast<const char*>(0), name, f, __FILE__, __LINE__, timeout,                     \
+            static_cast<doctest::detail::TestData*>(0)};
 #if defined(__GNUC__) && !defined(__clang__)
-#define DOCTEST_REGISTER_FUNCTION(f, name)                                                         \
+#define DOCTEST_REGISTER_FUNCTION(f, name, timeout)                                                \
+    DOCTEST_TEST_DATA(f, name, timeout)                                                            \
     static int DOCTEST_ANONYMOUS(DOCTEST_AUTOGEN_VAR_) __attribute__((unused)) =                   \
-            doctest::detail::regTest(f, __LINE__, __FILE__, name);
+            doctest::detail::regTest(&DOCTEST_CONCAT(f, _DATA));
 #elif defined(__clang__)
-#define DOCTEST_REGISTER_FUNCTION(f, name)                                                         \
+#define DOCTEST_REGISTER_FUNCTION(f, name, timeout)                                                \
+    DOCTEST_TEST_DATA(f, name, timeout)                                                            \
     _Pragma("clang diagnostic push")                                                               \
             _Pragma("clang diagnostic ignored \"-Wglobal-constructors\"") static int               \
                     DOCTEST_ANONYMOUS(DOCTEST_AUTOGEN_VAR_) =                                      \
-                            doctest::detail::regTest(f, __LINE__, __FILE__, name);                 \
+                            doctest::detail::regTest(&DOCTEST_CONCAT(f, _DATA));                   \
     _Pragma("clang diagnostic pop")
 #else // MSVC
-#define DOCTEST_REGISTER_FUNCTION(f, name)                                                         \
+#define DOCTEST_REGISTER_FUNCTION(f, name, timeout)                                                \
+    DOCTEST_TEST_DATA(f, name, timeout)                                                            \
     static int DOCTEST_ANONYMOUS(DOCTEST_AUTOGEN_VAR_) =                                           \
-            doctest::detail::regTest(f, __LINE__, __FILE__, name);
+            doctest::detail::regTest(&DOCTEST_CONCAT(f, _DATA));
 #endif // MSVC
 
-#define DOCTEST_IMPLEMENT_FIXTURE(der, base, func, name)                                           \
+#define DOCTEST_IMPLEMENT_FIXTURE(der, base, func, name, timeout)                                  \
     namespace                                                                                      \
     {                                                                                              \
         struct der : base                                                                          \
@@ -709,23 +1038,32 @@ public:
             der v;                                                                                 \
             v.f();                                                                                 \
         }                                                                                          \
-        DOCTEST_REGISTER_FUNCTION(func, name)                                                      \
+        DOCTEST_REGISTER_FUNCTION(func, name, timeout)                                             \
     }                                                                                              \
     inline void der::f()
 
-#define DOCTEST_CREATE_AND_REGISTER_FUNCTION(f, name)                                              \
+#define DOCTEST_CREATE_AND_REGISTER_FUNCTION(f, name, timeout)                                     \
     static void f();                                                                               \
-    DOCTEST_REGISTER_FUNCTION(f, name)                                                             \
+    DOCTEST_REGISTER_FUNCTION(f, name, timeout)                                                    \
     inline void f()
 
 // for registering tests
 #define DOCTEST_TEST_CASE(name)                                                                    \
-    DOCTEST_CREATE_AND_REGISTER_FUNCTION(DOCTEST_ANONYMOUS(DOCTEST_AUTOGEN_FUNC_), name)
+    DOCTEST_CREATE_AND_REGISTER_FUNCTION(DOCTEST_ANONYMOUS(DOCTEST_AUTOGEN_FUNC_), name, 0)
 
 // for registering tests with a fixture
 #define DOCTEST_TEST_CASE_FIXTURE(c, name)                                                         \
     DOCTEST_IMPLEMENT_FIXTURE(DOCTEST_ANONYMOUS(DOCTEST_AUTOGEN_CLASS_), c,                        \
-                              DOCTEST_ANONYMOUS(DOCTEST_AUTOGEN_FUNC_), name)
+                              DOCTEST_ANONYMOUS(DOCTEST_AUTOGEN_FUNC_), name, 0)
+
+// for registering tests with a time limit in seconds - instead of the one from --dt-timeout
+#define DOCTEST_TEST_CASE_TIMEOUT(name, seconds)                                                   \
+    DOCTEST_CREATE_AND_REGISTER_FUNCTION(DOCTEST_ANONYMOUS(DOCTEST_AUTOGEN_FUNC_), name, seconds)
+
+// for registering tests with a fixture and a time limit in seconds
+#define DOCTEST_TEST_CASE_FIXTURE_TIMEOUT(c, name, seconds)                                        \
+    DOCTEST_IMPLEMENT_FIXTURE(DOCTEST_ANONYMOUS(DOCTEST_AUTOGEN_CLASS_), c,                        \
+                              DOCTEST_ANONYMOUS(DOCTEST_AUTOGEN_FUNC_), name, seconds)
 
 // for subcases
 #if defined(__GNUC__)
@@ -739,6 +1077,24 @@ public:
                doctest::detail::Subcase(name, __FILE__, __LINE__))
 #endif // __GNUC__
 
+// for benchmarks inside of test cases - the body is executed many times and the time it takes is
+// measured
+#define DOCTEST_BENCHMARK(name)                                                                    \
+    for(doctest::detail::Benchmark doctest_benchmark(name, __FILE__, __LINE__);                    \
+        doctest_benchmark.keepRunning();)
+
+// for checking the number of allocations in a block (with DOCTEST_CONFIG_TRACK_ALLOCATIONS)
+#define DOCTEST_ALLOCATION_CHECK(max, expr, assert_name)                                           \
+    for(doctest::detail::AllocationCheck doctest_allocation_check(max, assert_name, expr,          \
+                                                                  __FILE__, __LINE__);             \
+        doctest_allocation_check.once();)
+
+#define DOCTEST_CHECK_NO_ALLOCATIONS DOCTEST_ALLOCATION_CHECK(0, "", "CHECK_NO_ALLOCATIONS")
+#define DOCTEST_REQUIRE_NO_ALLOCATIONS DOCTEST_ALLOCATION_CHECK(0, "", "REQUIRE_NO_ALLOCATIONS")
+#define DOCTEST_CHECK_MAX_ALLOCATIONS(n) DOCTEST_ALLOCATION_CHECK(n, #n, "CHECK_MAX_ALLOCATIONS")
+#define DOCTEST_REQUIRE_MAX_ALLOCATIONS(n)                                                         \
+    DOCTEST_ALLOCATION_CHECK(n, #n, "REQUIRE_MAX_ALLOCATIONS")
+
 // for starting a testsuite block
 #if defined(__GNUC__) && !defined(__clang__)
 #define DOCTEST_TEST_SUITE(name)                                                                   \
@@ -777,25 +1133,14 @@ public:
     void       DOCTEST_ANONYMOUS(DOCTEST_AUTOGEN_TESTSUITE_END_)
 #endif // MSVC
 
-#define DOCTEST_LOG_START()                                                                        \
-    do {                                                                                           \
-        if(!DOCTEST_GCS()->hasLoggedCurrentTestStart) {                                            \
-            doctest::detail::logTestStart(DOCTEST_GCS()->currentTest->m_name,                      \
-                                          DOCTEST_GCS()->currentTest->m_file,                      \
-                                          DOCTEST_GCS()->currentTest->m_line);                     \
-            DOCTEST_GCS()->hasLoggedCurrentTestStart = true;                                       \
-        }                                                                                          \
-    } while(doctest::detail::always_false())
-
-#define DOCTEST_ASSERT_IMPLEMENT(expr, assert_name, false_invert_op)                               \
+#define DOCTEST_ASSERT_IMPLEMENT(expr, assert_name, is_false)                                      \
+    DOCTEST_GCS()->setLastAssert(__FILE__, __LINE__);                                              \
     doctest::detail::Result res;                                                                   \
     bool                    threw = false;                                                         \
     try {                                                                                          \
-        res = doctest::detail::ExpressionDecomposer() << expr;                                     \
+        res = doctest::detail::ExpressionDecomposer(is_false) << expr;                             \
     } catch(...) { threw = true; }                                                                 \
-    false_invert_op;                                                                               \
     if(res || DOCTEST_GCS()->success) {                                                            \
-        DOCTEST_LOG_START();                                                                       \
         doctest::detail::logAssert(res.m_passed, res.m_decomposition.c_str(), threw, #expr,        \
                                    assert_name, __FILE__, __LINE__);                               \
     }                                                                                              \
@@ -807,37 +1152,37 @@ public:
     }
 
 #if defined(__clang__)
-#define DOCTEST_ASSERT_PROXY(expr, assert_name, false_invert_op)                                   \
+#define DOCTEST_ASSERT_PROXY(expr, assert_name, is_false)                                          \
     do {                                                                                           \
         _Pragma("clang diagnostic push")                                                           \
                 _Pragma("clang diagnostic ignored \"-Woverloaded-shift-op-parentheses\"")          \
-                        DOCTEST_ASSERT_IMPLEMENT(expr, assert_name, false_invert_op)               \
+                        DOCTEST_ASSERT_IMPLEMENT(expr, assert_name, is_false)                      \
                                 _Pragma("clang diagnostic pop")                                    \
     } while(doctest::detail::always_false())
 #else // __clang__
-#define DOCTEST_ASSERT_PROXY(expr, assert_name, false_invert_op)                                   \
+#define DOCTEST_ASSERT_PROXY(expr, assert_name, is_false)                                          \
     do {                                                                                           \
-        DOCTEST_ASSERT_IMPLEMENT(expr, assert_name, false_invert_op)                               \
+        DOCTEST_ASSERT_IMPLEMENT(expr, assert_name, is_false)                                      \
     } while(doctest::detail::always_false())
 #endif // __clang__
 
-#define DOCTEST_WARN(expr) DOCTEST_ASSERT_PROXY(expr, "WARN", ((void)0))
-#define DOCTEST_CHECK(expr) DOCTEST_ASSERT_PROXY(expr, "CHECK", ((void)0))
-#define DOCTEST_REQUIRE(expr) DOCTEST_ASSERT_PROXY(expr, "REQUIRE", ((void)0))
+#define DOCTEST_WARN(expr) DOCTEST_ASSERT_PROXY(expr, "WARN", false)
+#define DOCTEST_CHECK(expr) DOCTEST_ASSERT_PROXY(expr, "CHECK", false)
+#define DOCTEST_REQUIRE(expr) DOCTEST_ASSERT_PROXY(expr, "REQUIRE", false)
 
-#define DOCTEST_WARN_FALSE(expr) DOCTEST_ASSERT_PROXY(expr, "WARN_FALSE", res.invert())
-#define DOCTEST_CHECK_FALSE(expr) DOCTEST_ASSERT_PROXY(expr, "CHECK_FALSE", res.invert())
-#define DOCTEST_REQUIRE_FALSE(expr) DOCTEST_ASSERT_PROXY(expr, "REQUIRE_FALSE", res.invert())
+#define DOCTEST_WARN_FALSE(expr) DOCTEST_ASSERT_PROXY(expr, "WARN_FALSE", true)
+#define DOCTEST_CHECK_FALSE(expr) DOCTEST_ASSERT_PROXY(expr, "CHECK_FALSE", true)
+#define DOCTEST_REQUIRE_FALSE(expr) DOCTEST_ASSERT_PROXY(expr, "REQUIRE_FALSE", true)
 
 #define DOCTEST_ASSERT_THROWS(expr, assert_name)                                                   \
     do {                                                                                           \
         if(!DOCTEST_GCS()->no_throw) {                                                             \
+            DOCTEST_GCS()->setLastAssert(__FILE__, __LINE__);                                      \
             bool threw = false;                                                                    \
             try {                                                                                  \
                 expr;                                                                              \
             } catch(...) { threw = true; }                                                         \
             if(!threw || DOCTEST_GCS()->success) {                                                 \
-                DOCTEST_LOG_START();                                                               \
                 doctest::detail::logAssertThrows(threw, #expr, assert_name, __FILE__, __LINE__);   \
             }                                                                                      \
             DOCTEST_GCS()->numAssertionsForCurrentTestcase++;                                      \
@@ -852,6 +1197,7 @@ public:
 #define DOCTEST_ASSERT_THROWS_AS(expr, as, assert_name)                                            \
     do {                                                                                           \
         if(!DOCTEST_GCS()->no_throw) {                                                             \
+            DOCTEST_GCS()->setLastAssert(__FILE__, __LINE__);                                      \
             bool threw    = false;                                                                 \
             bool threw_as = false;                                                                 \
             try {                                                                                  \
@@ -861,7 +1207,6 @@ public:
                 threw_as = true;                                                                   \
             } catch(...) { threw = true; }                                                         \
             if(!threw_as || DOCTEST_GCS()->success) {                                              \
-                DOCTEST_LOG_START();                                                               \
                 doctest::detail::logAssertThrowsAs(threw, threw_as, #as, #expr, assert_name,       \
                                                    __FILE__, __LINE__);                            \
             }                                                                                      \
@@ -877,12 +1222,12 @@ public:
 #define DOCTEST_ASSERT_NOTHROW(expr, assert_name)                                                  \
     do {                                                                                           \
         if(!DOCTEST_GCS()->no_throw) {                                                             \
+            DOCTEST_GCS()->setLastAssert(__FILE__, __LINE__);                                      \
             bool threw = false;                                                                    \
             try {                                                                                  \
                 expr;                                                                              \
             } catch(...) { threw = true; }                                                         \
             if(threw || DOCTEST_GCS()->success) {                                                  \
-                DOCTEST_LOG_START();                                                               \
                 doctest::detail::logAssertNothrow(threw, #expr, assert_name, __FILE__, __LINE__);  \
             }                                                                                      \
             DOCTEST_GCS()->numAssertionsForCurrentTestcase++;                                      \
@@ -906,6 +1251,130 @@ public:
 #define DOCTEST_CHECK_NOTHROW(expr) DOCTEST_ASSERT_NOTHROW(expr, "CHECK_NOTHROW")
 #define DOCTEST_REQUIRE_NOTHROW(expr) DOCTEST_ASSERT_NOTHROW(expr, "REQUIRE_NOTHROW")
 
+#define DOCTEST_BINARY_ASSERT(assert_name, comp, lhs, rhs)                                         \
+    do {                                                                                           \
+        bool doctest_failed = false;                                                               \
+        try {                                                                                      \
+            doctest_failed =                                                                       \
+                    doctest::detail::binaryAssert<doctest::detail::binaryAssertComparison::comp>(  \
+                            assert_name, __FILE__, __LINE__, #lhs ", " #rhs, lhs, rhs);            \
+        } catch(...) {                                                                             \
+            doctest_failed = doctest::detail::logBinaryAssert(false, "", true, #lhs ", " #rhs,     \
+                                                              assert_name, __FILE__, __LINE__);    \
+        }                                                                                          \
+        if(doctest_failed) {                                                                       \
+            DOCTEST_BREAK_INTO_DEBUGGER();                                                         \
+            doctest::detail::checkIfShouldThrow(assert_name);                                      \
+        }                                                                                          \
+    } while(doctest::detail::always_false())
+
+#define DOCTEST_UNARY_ASSERT(assert_name, is_false, val)                                           \
+    do {                                                                                           \
+        bool doctest_failed = false;                                                               \
+        try {                                                                                      \
+            doctest_failed = doctest::detail::unaryAssert<is_false>(assert_name, __FILE__,         \
+                                                                    __LINE__, #val, val);          \
+        } catch(...) {                                                                             \
+            doctest_failed = doctest::detail::logBinaryAssert(false, "", true, #val, assert_name,  \
+                                                              __FILE__, __LINE__);                 \
+        }                                                                                          \
+        if(doctest_failed) {                                                                       \
+            DOCTEST_BREAK_INTO_DEBUGGER();                                                         \
+            doctest::detail::checkIfShouldThrow(assert_name);                                      \
+        }                                                                                          \
+    } while(doctest::detail::always_false())
+
+// the FAST_ versions have no try/catch - an exception from the operands ends the test case
+#define DOCTEST_FAST_BINARY_ASSERT(assert_name, comp, lhs, rhs)                                    \
+    do {                                                                                           \
+        if(doctest::detail::binaryAssert<doctest::detail::binaryAssertComparison::comp>(           \
+                   assert_name, __FILE__, __LINE__, #lhs ", " #rhs, lhs, rhs)) {                   \
+            DOCTEST_BREAK_INTO_DEBUGGER();                                                         \
+            doctest::detail::checkIfShouldThrow(assert_name);                                      \
+        }                                                                                          \
+    } while(doctest::detail::always_false())
+
+#define DOCTEST_FAST_UNARY_ASSERT(assert_name, is_false, val)                                      \
+    do {                                                                                           \
+        if(doctest::detail::unaryAssert<is_false>(assert_name, __FILE__, __LINE__, #val, val)) {   \
+            DOCTEST_BREAK_INTO_DEBUGGER();                                                         \
+            doctest::detail::checkIfShouldThrow(assert_name);                                      \
+        }                                                                                          \
+    } while(doctest::detail::always_false())
+
+#define DOCTEST_WARN_EQ(lhs, rhs) DOCTEST_BINARY_ASSERT("WARN_EQ", eq, lhs, rhs)
+#define DOCTEST_CHECK_EQ(lhs, rhs) DOCTEST_BINARY_ASSERT("CHECK_EQ", eq, lhs, rhs)
+#define DOCTEST_REQUIRE_EQ(lhs, rhs) DOCTEST_BINARY_ASSERT("REQUIRE_EQ", eq, lhs, rhs)
+
+#define DOCTEST_WARN_NE(lhs, rhs) DOCTEST_BINARY_ASSERT("WARN_NE", ne, lhs, rhs)
+#define DOCTEST_CHECK_NE(lhs, rhs) DOCTEST_BINARY_ASSERT("CHECK_NE", ne, lhs, rhs)
+#define DOCTEST_REQUIRE_NE(lhs, rhs) DOCTEST_BINARY_ASSERT("REQUIRE_NE", ne, lhs, rhs)
+
+#define DOCTEST_WARN_GT(lhs, rhs) DOCTEST_BINARY_ASSERT("WARN_GT", gt, lhs, rhs)
+#define DOCTEST_CHECK_GT(lhs, rhs) DOCTEST_BINARY_ASSERT("CHECK_GT", gt, lhs, rhs)
+#define DOCTEST_REQUIRE_GT(lhs, rhs) DOCTEST_BINARY_ASSERT("REQUIRE_GT", gt, lhs, rhs)
+
+#define DOCTEST_WARN_LT(lhs, rhs) DOCTEST_BINARY_ASSERT("WARN_LT", lt, lhs, rhs)
+#define DOCTEST_CHECK_LT(lhs, rhs) DOCTEST_BINARY_ASSERT("CHECK_LT", lt, lhs, rhs)
+#define DOCTEST_REQUIRE_LT(lhs, rhs) DOCTEST_BINARY_ASSERT("REQUIRE_LT", lt, lhs, rhs)
+
+#define DOCTEST_WARN_GE(lhs, rhs) DOCTEST_BINARY_ASSERT("WARN_GE", ge, lhs, rhs)
+#define DOCTEST_CHECK_GE(lhs, rhs) DOCTEST_BINARY_ASSERT("CHECK_GE", ge, lhs, rhs)
+#define DOCTEST_REQUIRE_GE(lhs, rhs) DOCTEST_BINARY_ASSERT("REQUIRE_GE", ge, lhs, rhs)
+
+#define DOCTEST_WARN_LE(lhs, rhs) DOCTEST_BINARY_ASSERT("WARN_LE", le, lhs, rhs)
+#define DOCTEST_CHECK_LE(lhs, rhs) DOCTEST_BINARY_ASSERT("CHECK_LE", le, lhs, rhs)
+#define DOCTEST_REQUIRE_LE(lhs, rhs) DOCTEST_BINARY_ASSERT("REQUIRE_LE", le, lhs, rhs)
+
+#define DOCTEST_WARN_UNARY(val) DOCTEST_UNARY_ASSERT("WARN_UNARY", false, val)
+#define DOCTEST_CHECK_UNARY(val) DOCTEST_UNARY_ASSERT("CHECK_UNARY", false, val)
+#define DOCTEST_REQUIRE_UNARY(val) DOCTEST_UNARY_ASSERT("REQUIRE_UNARY", false, val)
+
+#define DOCTEST_WARN_UNARY_FALSE(val) DOCTEST_UNARY_ASSERT("WARN_UNARY_FALSE", true, val)
+#define DOCTEST_CHECK_UNARY_FALSE(val) DOCTEST_UNARY_ASSERT("CHECK_UNARY_FALSE", true, val)
+#define DOCTEST_REQUIRE_UNARY_FALSE(val) DOCTEST_UNARY_ASSERT("REQUIRE_UNARY_FALSE", true, val)
+
+#define DOCTEST_FAST_WARN_EQ(lhs, rhs) DOCTEST_FAST_BINARY_ASSERT("FAST_WARN_EQ", eq, lhs, rhs)
+#define DOCTEST_FAST_CHECK_EQ(lhs, rhs) DOCTEST_FAST_BINARY_ASSERT("FAST_CHECK_EQ", eq, lhs, rhs)
+#define DOCTEST_FAST_REQUIRE_EQ(lhs, rhs)                                                          \
+    DOCTEST_FAST_BINARY_ASSERT("FAST_REQUIRE_EQ", eq, lhs, rhs)
+
+#define DOCTEST_FAST_WARN_NE(lhs, rhs) DOCTEST_FAST_BINARY_ASSERT("FAST_WARN_NE", ne, lhs, rhs)
+#define DOCTEST_FAST_CHECK_NE(lhs, rhs) DOCTEST_FAST_BINARY_ASSERT("FAST_CHECK_NE", ne, lhs, rhs)
+#define DOCTEST_FAST_REQUIRE_NE(lhs, rhs)                                                          \
+    DOCTEST_FAST_BINARY_ASSERT("FAST_REQUIRE_NE", ne, lhs, rhs)
+
+#define DOCTEST_FAST_WARN_GT(lhs, rhs) DOCTEST_FAST_BINARY_ASSERT("FAST_WARN_GT", gt, lhs, rhs)
+#define DOCTEST_FAST_CHECK_GT(lhs, rhs) DOCTEST_FAST_BINARY_ASSERT("FAST_CHECK_GT", gt, lhs, rhs)
+#define DOCTEST_FAST_REQUIRE_GT(lhs, rhs)                                                          \
+    DOCTEST_FAST_BINARY_ASSERT("FAST_REQUIRE_GT", gt, lhs, rhs)
+
+#define DOCTEST_FAST_WARN_LT(lhs, rhs) DOCTEST_FAST_BINARY_ASSERT("FAST_WARN_LT", lt, lhs, rhs)
+#define DOCTEST_FAST_CHECK_LT(lhs, rhs) DOCTEST_FAST_BINARY_ASSERT("FAST_CHECK_LT", lt, lhs, rhs)
+#define DOCTEST_FAST_REQUIRE_LT(lhs, rhs)                                                          \
+    DOCTEST_FAST_BINARY_ASSERT("FAST_REQUIRE_LT", lt, lhs, rhs)
+
+#define DOCTEST_FAST_WARN_GE(lhs, rhs) DOCTEST_FAST_BINARY_ASSERT("FAST_WARN_GE", ge, lhs, rhs)
+#define DOCTEST_FAST_CHECK_GE(lhs, rhs) DOCTEST_FAST_BINARY_ASSERT("FAST_CHECK_GE", ge, lhs, rhs)
+#define DOCTEST_FAST_REQUIRE_GE(lhs, rhs)                                                          \
+    DOCTEST_FAST_BINARY_ASSERT("FAST_REQUIRE_GE", ge, lhs, rhs)
+
+#define DOCTEST_FAST_WARN_LE(lhs, rhs) DOCTEST_FAST_BINARY_ASSERT("FAST_WARN_LE", le, lhs, rhs)
+#define DOCTEST_FAST_CHECK_LE(lhs, rhs) DOCTEST_FAST_BINARY_ASSERT("FAST_CHECK_LE", le, lhs, rhs)
+#define DOCTEST_FAST_REQUIRE_LE(lhs, rhs)                                                          \
+    DOCTEST_FAST_BINARY_ASSERT("FAST_REQUIRE_LE", le, lhs, rhs)
+
+#define DOCTEST_FAST_WARN_UNARY(val) DOCTEST_FAST_UNARY_ASSERT("FAST_WARN_UNARY", false, val)
+#define DOCTEST_FAST_CHECK_UNARY(val) DOCTEST_FAST_UNARY_ASSERT("FAST_CHECK_UNARY", false, val)
+#define DOCTEST_FAST_REQUIRE_UNARY(val) DOCTEST_FAST_UNARY_ASSERT("FAST_REQUIRE_UNARY", false, val)
+
+#define DOCTEST_FAST_WARN_UNARY_FALSE(val)                                                         \
+    DOCTEST_FAST_UNARY_ASSERT("FAST_WARN_UNARY_FALSE", true, val)
+#define DOCTEST_FAST_CHECK_UNARY_FALSE(val)                                                        \
+    DOCTEST_FAST_UNARY_ASSERT("FAST_CHECK_UNARY_FALSE", true, val)
+#define DOCTEST_FAST_REQUIRE_UNARY_FALSE(val)                                                      \
+    DOCTEST_FAST_UNARY_ASSERT("FAST_REQUIRE_UNARY_FALSE", true, val)
+
 // =================================================================================================
 // == WHAT FOLLOWS IS VERSIONS OF THE MACROS THAT DO NOT DO ANY REGISTERING!                      ==
 // == THIS CAN BE ENABLED BY DEFINING DOCTEST_CONFIG_DISABLE GLOBALLY!                            ==
@@ -935,9 +1404,24 @@ public:
     DOCTEST_IMPLEMENT_FIXTURE(DOCTEST_ANONYMOUS(DOCTEST_AUTOGEN_CLASS_), x,                        \
                               DOCTEST_ANONYMOUS(DOCTEST_AUTOGEN_FUNC_), name)
 
+// for registering tests with a time limit
+#define DOCTEST_TEST_CASE_TIMEOUT(name, seconds) DOCTEST_TEST_CASE(name)
+
+// for registering tests with a fixture and a time limit
+#define DOCTEST_TEST_CASE_FIXTURE_TIMEOUT(x, name, seconds) DOCTEST_TEST_CASE_FIXTURE(x, name)
+
 // for subcases
 #define DOCTEST_SUBCASE(name)
 
+// for benchmarks
+#define DOCTEST_BENCHMARK(name)
+
+// for checking the number of allocations in a block
+#define DOCTEST_CHECK_NO_ALLOCATIONS
+#define DOCTEST_REQUIRE_NO_ALLOCATIONS
+#define DOCTEST_CHECK_MAX_ALLOCATIONS(n)
+#define DOCTEST_REQUIRE_MAX_ALLOCATIONS(n)
+
 // for starting a testsuite block
 #define DOCTEST_TEST_SUITE(name) void DOCTEST_ANONYMOUS(DOCTEST_AUTOGEN_FOR_SEMICOLON_)()
 
@@ -960,6 +1444,56 @@ public:
 #define DOCTEST_REQUIRE_THROWS_AS(expr, ex) ((void)0)
 #define DOCTEST_REQUIRE_NOTHROW(expr) ((void)0)
 
+#define DOCTEST_WARN_EQ(lhs, rhs) ((void)0)
+#define DOCTEST_WARN_NE(lhs, rhs) ((void)0)
+#define DOCTEST_WARN_GT(lhs, rhs) ((void)0)
+#define DOCTEST_WARN_LT(lhs, rhs) ((void)0)
+#define DOCTEST_WARN_GE(lhs, rhs) ((void)0)
+#define DOCTEST_WARN_LE(lhs, rhs) ((void)0)
+#define DOCTEST_WARN_UNARY(val) ((void)0)
+#define DOCTEST_WARN_UNARY_FALSE(val) ((void)0)
+#define DOCTEST_CHECK_EQ(lhs, rhs) ((void)0)
+#define DOCTEST_CHECK_NE(lhs, rhs) ((void)0)
+#define DOCTEST_CHECK_GT(lhs, rhs) ((void)0)
+#define DOCTEST_CHECK_LT(lhs, rhs) ((void)0)
+#define DOCTEST_CHECK_GE(lhs, rhs) ((void)0)
+#define DOCTEST_CHECK_LE(lhs, rhs) ((void)0)
+#define DOCTEST_CHECK_UNARY(val) ((void)0)
+#define DOCTEST_CHECK_UNARY_FALSE(val) ((void)0)
+#define DOCTEST_REQUIRE_EQ(lhs, rhs) ((void)0)
+#define DOCTEST_REQUIRE_NE(lhs, rhs) ((void)0)
+#define DOCTEST_REQUIRE_GT(lhs, rhs) ((void)0)
+#define DOCTEST_REQUIRE_LT(lhs, rhs) ((void)0)
+#define DOCTEST_REQUIRE_GE(lhs, rhs) ((void)0)
+#define DOCTEST_REQUIRE_LE(lhs, rhs) ((void)0)
+#define DOCTEST_REQUIRE_UNARY(val) ((void)0)
+#define DOCTEST_REQUIRE_UNARY_FALSE(val) ((void)0)
+
+#define DOCTEST_FAST_WARN_EQ(lhs, rhs) ((void)0)
+#define DOCTEST_FAST_WARN_NE(lhs, rhs) ((void)0)
+#define DOCTEST_FAST_WARN_GT(lhs, rhs) ((void)0)
+#define DOCTEST_FAST_WARN_LT(lhs, rhs) ((void)0)
+#define DOCTEST_FAST_WARN_GE(lhs, rhs) ((void)0)
+#define DOCTEST_FAST_WARN_LE(lhs, rhs) ((void)0)
+#define DOCTEST_FAST_WARN_UNARY(val) ((void)0)
+#define DOCTEST_FAST_WARN_UNARY_FALSE(val) ((void)0)
+#define DOCTEST_FAST_CHECK_EQ(lhs, rhs) ((void)0)
+#define DOCTEST_FAST_CHECK_NE(lhs, rhs) ((void)0)
+#define DOCTEST_FAST_CHECK_GT(lhs, rhs) ((void)0)
+#define DOCTEST_FAST_CHECK_LT(lhs, rhs) ((void)0)
+#define DOCTEST_FAST_CHECK_GE(lhs, rhs) ((void)0)
+#define DOCTEST_FAST_CHECK_LE(lhs, rhs) ((void)0)
+#define DOCTEST_FAST_CHECK_UNARY(val) ((void)0)
+#define DOCTEST_FAST_CHECK_UNARY_FALSE(val) ((void)0)
+#define DOCTEST_FAST_REQUIRE_EQ(lhs, rhs) ((void)0)
+#define DOCTEST_FAST_REQUIRE_NE(lhs, rhs) ((void)0)
+#define DOCTEST_FAST_REQUIRE_GT(lhs, rhs) ((void)0)
+#define DOCTEST_FAST_REQUIRE_LT(lhs, rhs) ((void)0)
+#define DOCTEST_FAST_REQUIRE_GE(lhs, rhs) ((void)0)
+#define DOCTEST_FAST_REQUIRE_LE(lhs, rhs) ((void)0)
+#define DOCTEST_FAST_REQUIRE_UNARY(val) ((void)0)
+#define DOCTEST_FAST_REQUIRE_UNARY_FALSE(val) ((void)0)
+
 #endif // DOCTEST_CONFIG_DISABLE
 
 // BDD style macros
@@ -975,7 +1509,14 @@ public:
 
 #define TEST_CASE DOCTEST_TEST_CASE
 #define TEST_CASE_FIXTURE DOCTEST_TEST_CASE_FIXTURE
+#define TEST_CASE_TIMEOUT DOCTEST_TEST_CASE_TIMEOUT
+#define TEST_CASE_FIXTURE_TIMEOUT DOCTEST_TEST_CASE_FIXTURE_TIMEOUT
 #define SUBCASE DOCTEST_SUBCASE
+#define BENCHMARK DOCTEST_BENCHMARK
+#define CHECK_NO_ALLOCATIONS DOCTEST_CHECK_NO_ALLOCATIONS
+#define REQUIRE_NO_ALLOCATIONS DOCTEST_REQUIRE_NO_ALLOCATIONS
+#define CHECK_MAX_ALLOCATIONS DOCTEST_CHECK_MAX_ALLOCATIONS
+#define REQUIRE_MAX_ALLOCATIONS DOCTEST_REQUIRE_MAX_ALLOCATIONS
 #define TEST_SUITE DOCTEST_TEST_SUITE
 #define TEST_SUITE_END DOCTEST_TEST_SUITE_END
 #define WARN DOCTEST_WARN
@@ -994,6 +1535,56 @@ public:
 #define REQUIRE_THROWS_AS DOCTEST_REQUIRE_THROWS_AS
 #define REQUIRE_NOTHROW DOCTEST_REQUIRE_NOTHROW
 
+#define WARN_EQ DOCTEST_WARN_EQ
+#define WARN_NE DOCTEST_WARN_NE
+#define WARN_GT DOCTEST_WARN_GT
+#define WARN_LT DOCTEST_WARN_LT
+#define WARN_GE DOCTEST_WARN_GE
+#define WARN_LE DOCTEST_WARN_LE
+#define WARN_UNARY DOCTEST_WARN_UNARY
+#define WARN_UNARY_FALSE DOCTEST_WARN_UNARY_FALSE
+#define CHECK_EQ DOCTEST_CHECK_EQ
+#define CHECK_NE DOCTEST_CHECK_NE
+#define CHECK_GT DOCTEST_CHECK_GT
+#define CHECK_LT DOCTEST_CHECK_LT
+#define CHECK_GE DOCTEST_CHECK_GE
+#define CHECK_LE DOCTEST_CHECK_LE
+#define CHECK_UNARY DOCTEST_CHECK_UNARY
+#define CHECK_UNARY_FALSE DOCTEST_CHECK_UNARY_FALSE
+#define REQUIRE_EQ DOCTEST_REQUIRE_EQ
+#define REQUIRE_NE DOCTEST_REQUIRE_NE
+#define REQUIRE_GT DOCTEST_REQUIRE_GT
+#define REQUIRE_LT DOCTEST_REQUIRE_LT
+#define REQUIRE_GE DOCTEST_REQUIRE_GE
+#define REQUIRE_LE DOCTEST_REQUIRE_LE
+#define REQUIRE_UNARY DOCTEST_REQUIRE_UNARY
+#define REQUIRE_UNARY_FALSE DOCTEST_REQUIRE_UNARY_FALSE
+
+#define FAST_WARN_EQ DOCTEST_FAST_WARN_EQ
+#define FAST_WARN_NE DOCTEST_FAST_WARN_NE
+#define FAST_WARN_GT DOCTEST_FAST_WARN_GT
+#define FAST_WARN_LT DOCTEST_FAST_WARN_LT
+#define FAST_WARN_GE DOCTEST_FAST_WARN_GE
+#define FAST_WARN_LE DOCTEST_FAST_WARN_LE
+#define FAST_WARN_UNARY DOCTEST_FAST_WARN_UNARY
+#define FAST_WARN_UNARY_FALSE DOCTEST_FAST_WARN_UNARY_FALSE
+#define FAST_CHECK_EQ DOCTEST_FAST_CHECK_EQ
+#define FAST_CHECK_NE DOCTEST_FAST_CHECK_NE
+#define FAST_CHECK_GT DOCTEST_FAST_CHECK_GT
+#define FAST_CHECK_LT DOCTEST_FAST_CHECK_LT
+#define FAST_CHECK_GE DOCTEST_FAST_CHECK_GE
+#define FAST_CHECK_LE DOCTEST_FAST_CHECK_LE
+#define FAST_CHECK_UNARY DOCTEST_FAST_CHECK_UNARY
+#define FAST_CHECK_UNARY_FALSE DOCTEST_FAST_CHECK_UNARY_FALSE
+#define FAST_REQUIRE_EQ DOCTEST_FAST_REQUIRE_EQ
+#define FAST_REQUIRE_NE DOCTEST_FAST_REQUIRE_NE
+#define FAST_REQUIRE_GT DOCTEST_FAST_REQUIRE_GT
+#define FAST_REQUIRE_LT DOCTEST_FAST_REQUIRE_LT
+#define FAST_REQUIRE_GE DOCTEST_FAST_REQUIRE_GE
+#define FAST_REQUIRE_LE DOCTEST_FAST_REQUIRE_LE
+#define FAST_REQUIRE_UNARY DOCTEST_FAST_REQUIRE_UNARY
+#define FAST_REQUIRE_UNARY_FALSE DOCTEST_FAST_REQUIRE_UNARY_FALSE
+
 #define SCENARIO DOCTEST_SCENARIO
 #define GIVEN DOCTEST_GIVEN
 #define WHEN DOCTEST_WHEN
@@ -1022,6 +1613,7 @@ DOCTEST_TEST_SUITE_END();
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <csignal>
 #include <limits>
 #include <sstream>
 #include <iomanip>
@@ -1045,6 +1637,11 @@ namespace detail
         return lhs > rhs ? lhs : rhs;
     }
 
+    template <typename T>
+    T my_min(const T& lhs, const T& rhs) {
+        return lhs < rhs ? lhs : rhs;
+    }
+
     // case insensitive strcmp
     int stricmp(char const* a, char const* b) {
         for(;; a++, b++) {
@@ -1054,9 +1651,21 @@ namespace detail
         }
     }
 
+    // the allocations of the framework with operator new (of its ostringstreams) are excluded
+    // from the ones of the tests (DOCTEST_CONFIG_TRACK_ALLOCATIONS) - the pauses can be nested
+    void pauseAllocationTracking();
+    void resumeAllocationTracking();
+
+    struct AllocationTrackingPause
+    {
+        AllocationTrackingPause() { pauseAllocationTracking(); }
+        ~AllocationTrackingPause() { resumeAllocationTracking(); }
+    };
+
     template <typename T>
     String fpToString(T value, int precision) {
-        std::ostringstream oss;
+        AllocationTrackingPause pause;
+        std::ostringstream      oss;
         oss << std::setprecision(precision) << std::fixed << value;
         std::string d = oss.str();
         size_t      i = d.find_last_not_of('0');
@@ -1089,6 +1698,7 @@ namespace detail
     };
 
     String rawMemoryToString(const void* object, unsigned size) {
+        AllocationTrackingPause pause;
         // Reverse order for little endian architectures
         int i = 0, end = static_cast<int>(size), inc = 1;
         if(Endianness::which() == Endianness::Little) {
@@ -1104,11 +1714,20 @@ namespace detail
         return os.str().c_str();
     }
 
-    std::ostream* createStream() { return new std::ostringstream(); }
+    // tracking allocations is paused from the creation of the stream until it is freed
+    std::ostream* createStream() {
+        pauseAllocationTracking();
+        return new std::ostringstream();
+    }
     String getStreamResult(std::ostream* in) {
         return static_cast<std::ostringstream*>(in)->str().c_str();
     }
-    void freeStream(std::ostream* in) { delete in; }
+    void freeStream(std::ostream* in) {
+        delete in;
+        resumeAllocationTracking();
+    }
+
+    void useCharPointer(const volatile char*) {}
 
 #ifndef DOCTEST_CONFIG_DISABLE
     template <class T>
@@ -1138,41 +1757,130 @@ namespace detail
         void resize(unsigned num, const T& val = T());
     };
 
-    // the default Hash() implementation that the HashTable class uses - returns 0 - very naive
-    // specialize for better HashTable performance
-    template <typename T>
-    unsigned Hash(const T&) {
-        return 0;
+    // the result of matching a string against a filter - cached by the address of the string
+    struct CachedMatch
+    {
+        const char* str;
+        bool        matches;
+
+        bool operator==(const CachedMatch& other) const { return str == other.str; }
+    };
+
+    // the hash functions for the types stored in a HashTable
+    unsigned Hash(const String& in);
+    unsigned Hash(const CachedMatch& in);
+
+    // spreads the bits of a hash so nearby values don't end up in nearby slots (murmur3 finalizer)
+    inline unsigned mixHash(unsigned hash) {
+        hash ^= hash >> 16;
+        hash *= 0x85ebca6bu;
+        hash ^= hash >> 13;
+        hash *= 0xc2b2ae35u;
+        hash ^= hash >> 16;
+        return hash;
     }
 
+    // an open addressing (linear probing) hash set. The items are stored in a flat array in the
+    // order of insertion and the slots hold indexes into it - so iterating is cache friendly and
+    // growing the table (when more than half of the slots are used) doesn't copy the items
     template <class T>
     class HashTable
     {
-        Vector<Vector<T> > buckets;
+        Vector<T>        items;  // the items in the order of insertion
+        Vector<unsigned> hashes; // the hash of each item - not recomputed when growing
+        Vector<unsigned> slots;  // index + 1 of an item - or 0 for an empty slot
+
+        // the slot with an item equal to 'in' - or the empty slot where it would go
+        unsigned findSlot(const T& in, unsigned hash) const {
+            unsigned mask = slots.size() - 1;
+            for(unsigned i = hash & mask;; i = (i + 1) & mask)
+                if(slots[i] == 0 || (hashes[slots[i] - 1] == hash && items[slots[i] - 1] == in))
+                    return i;
+        }
+
+        void grow() {
+            Vector<unsigned> newSlots(slots.size() * 2, 0);
+            unsigned         mask = newSlots.size() - 1;
+            for(unsigned k = 0; k < items.size(); ++k) {
+                unsigned i = hashes[k] & mask;
+                while(newSlots[i] != 0)
+                    i = (i + 1) & mask;
+                newSlots[i] = k + 1;
+            }
+            slots = newSlots;
+        }
 
     public:
-        explicit HashTable(unsigned num_buckets)
-                : buckets(num_buckets) {}
+        // the number of slots is rounded up to a power of 2
+        explicit HashTable(unsigned num_slots)
+                : slots(16, 0) {
+            while(slots.size() < num_slots)
+                grow();
+        }
 
-        bool has(const T& in) const {
-            const Vector<T>& bucket = buckets[Hash(in) % buckets.size()];
-            for(unsigned i = 0; i < bucket.size(); ++i)
-                if(bucket[i] == in)
-                    return true;
-            return false;
+        bool has(const T& in) const { return slots[findSlot(in, mixHash(Hash(in)))] != 0; }
+
+        // returns the stored item equal to 'in' - or null if there is no such item
+        const T* find(const T& in) const {
+            unsigned slot = slots[findSlot(in, mixHash(Hash(in)))];
+            return slot != 0 ? &items[slot - 1] : 0;
         }
 
         void insert(const T& in) {
-            if(!has(in))
-                buckets[Hash(in) % buckets.size()].push_back(in);
+            unsigned hash = mixHash(Hash(in));
+            unsigned slot = findSlot(in, hash);
+            if(slots[slot] != 0)
+                return;
+            items.push_back(in);
+            hashes.push_back(hash);
+            slots[slot] = items.size();
+            if(items.size() * 2 > slots.size())
+                grow();
         }
 
         void clear() {
-            for(unsigned i = 0; i < buckets.size(); ++i)
-                buckets[i].clear();
+            if(items.size() == 0)
+                return;
+            items.clear();
+            hashes.clear();
+            for(unsigned i = 0; i < slots.size(); ++i)
+                slots[i] = 0;
         }
 
-        const Vector<Vector<T> >& getBuckets() const { return buckets; }
+        const Vector<T>& getItems() const { return items; }
+    };
+
+    struct Reporters;
+    struct RecordedBenchmark;
+    class Watchdog;
+
+    // a subcase in the tree of the subcases of the test being executed - identified by its parent
+    // and its location so the same SUBCASE reached through different parents is a different node
+    // (and one inside of a loop is the same node each time). The nodes are indices in a vector
+    // (0 is the test case itself) with runs of the test function as "time stamps" - so nothing
+    // has to be cleared between the runs and the memory is reused for the next test case
+    struct SubcaseNode
+    {
+        const char* name;
+        const char* file;
+        int         line;
+        unsigned    parent;
+        unsigned    depth;           // 0 for the root (the test case itself)
+        unsigned    ordinal;         // among the children of the parent - in the order reached
+        unsigned    firstChild;      // 0 for none - the root is nobody's child
+        unsigned    nextSibling;     // 0 for none
+        unsigned    childEnteredRun; // the last run in which one of the children was entered
+        unsigned    unfinishedRun;   // the last run in which some of the children were skipped
+        bool        passed;          // if all paths through it have been executed
+        bool        matched;         // if it (or a subcase it is in) matches a --dt-subcase filter
+    };
+
+    // a subcase on the path entered by a run of a test with --dt-parallel-subcases
+    struct SubcaseStep
+    {
+        const char* file;
+        int         line;
+        unsigned    ordinal; // among its siblings - for ordering the runs as when serial
     };
 
     // this holds both parameters for the command line and runtime data for tests
@@ -1185,10 +1893,30 @@ namespace detail
         String   order_by;  // how tests should be ordered
         unsigned rand_seed; // the seed for rand ordering
 
+        String durations_file; // where durations of tests are recorded for --dt-jobs/--dt-workers
+        String isolate;        // how tests are isolated from each other - "fork" for a process each
+
+        detail::Vector<String> reporter_names; // which reporters to use - "console" by default
+        String                 out;            // a file for the junit/binlog reporter output
+        String                 decode_log;     // a binary log to report instead of running tests
+
+        detail::Vector<String> perf_counter_names; // the events counted for tests and benchmarks
+
+        String benchmark_out;        // where the results of benchmarks are recorded
+        String benchmark_baseline;   // the results of benchmarks from a previous run
+        int    benchmark_samples;    // the number of measured samples of each benchmark
+        int    benchmark_time;       // the target duration of a sample of a benchmark in ms
+        int    benchmark_threshold;  // how many percent slower than the baseline is still fine
+        int    benchmark_confidence; // in percent - for deciding if a benchmark is slower
+
         unsigned first; // the first (matching) test to be executed
         unsigned last;  // the last (matching) test to be executed
 
         int  abort_after;    // stop tests after this many failed assertions
+        int  timeout;        // the time limit of each test in seconds (0 means none)
+        int  jobs;           // the number of threads to execute tests with (1 means serially)
+        int  workers;        // the number of processes to execute tests with (1 means none)
+        int  slowest;        // the number of slowest tests printed with --dt-durations
         bool case_sensitive; // if filtering should be case sensitive
         bool exit;           // if the program should be exited after the tests are ran/whatever
         bool no_overrides;   // to disable overrides from code
@@ -1196,13 +1924,17 @@ namespace detail
         bool no_run;         // to not run the tests at all (can be done with an "*" exclude)
         bool no_colors;      // if output to the console should be colorized
         bool no_path_in_filenames; // if the path to files should be removed from the output
+        bool async_reporters;      // if the reporters should be fed by a separate thread
+        bool durations;            // to print the durations of tests and the slowest ones
+        bool allocations;          // to print the allocations of tests
+        bool fork_subcases;        // if subcases are entered by forked processes (UNIX only)
+        bool parallel_subcases;    // if the paths through subcases are split among --dt-jobs
 
         bool help;                 // to print the help
         bool version;              // to print the version
         bool count;                // if only the count of matching tests is to be retreived
         bool list_test_cases;      // to list all tests matching the filters
         bool list_test_suites;     // to list all suites matching the filters
-        bool hash_table_histogram; // if the hash table should be printed as a histogram
 
         // == data for the tests being ran
 
@@ -1210,22 +1942,71 @@ namespace detail
         int numFailedAssertions;
         int numFailedAssertionsForCurrentTestcase;
 
+        // the test cases executed (serially) so far - for ending the run if one of them crashes
+        unsigned numTestCasesExecuted;
+        unsigned numFailedTestCases;
+
         // stuff for subcases
-        HashTable<Subcase> subcasesPassed;
-        HashTable<int>     subcasesEnteredLevels;
-        Vector<Subcase>    subcasesStack;
-        int                subcasesCurrentLevel;
-        bool               subcasesHasSkipped;
+        Vector<SubcaseNode> subcaseTree;
+        unsigned            subcasesCurrent; // the node of the innermost entered subcase
+        unsigned            subcasesRun;     // which run of the test function this is
+        bool                subcasesHasSkipped;
+        unsigned            subcasesLastEntered; // the innermost subcase entered in this run
+
+        // for --dt-parallel-subcases - the path to the subcase entered by the run (the others on
+        // the way are skipped) and where the paths to the subcases left for other runs are added
+        Vector<SubcaseStep>           subcasesPath;
+        Vector<Vector<SubcaseStep> >* subcasesSpawned; // 0 if the subcases aren't split
+
+        // the reporters of the run - shared by the worker threads of --dt-jobs
+        Reporters* reporters;
+        // reporters added with Context::addReporter() - in addition to the console reporter
+        Vector<IReporter*> addedReporters;
+
+        // the results from --dt-benchmark-baseline (sorted) - shared by the worker threads
+        const Vector<RecordedBenchmark>* benchmarkBaseline;
+
+        // the events from --dt-perf-counters which can be counted (bits of perfCounter::Enum)
+        unsigned perfCounters;
+
+        // if set - the events for reporters are captured here instead of reported (by the workers
+        // of --dt-jobs and --dt-workers) - they are replayed in the order of the tests
+        Vector<char>* capturedEvents;
+
+        // interrupts the tests which run over their time limit (0 if none of the tests have one) -
+        // shared by the worker threads of --dt-jobs
+        Watchdog* watchdog;
+        double    currentTestTimeout; // the time limit of the test being executed (0 for none)
+
+        // no_colors and if stdout is a terminal - queried once for a run and not for each color
+        bool useColors;
 
         void resetRunData() {
-            numAssertions       = 0;
-            numFailedAssertions = 0;
+            numAssertions        = 0;
+            numFailedAssertions  = 0;
+            numTestCasesExecuted = 0;
+            numFailedTestCases   = 0;
         }
 
         ContextState()
-                : filters(6) // 6 different filters total
-                , subcasesPassed(100)
-                , subcasesEnteredLevels(100) {
+                : filters(8) // 8 different filters total
+                , subcasesCurrent(0)
+                , subcasesRun(0)
+                , subcasesHasSkipped(false)
+                , subcasesLastEntered(0)
+                , subcasesSpawned(0)
+                , reporters(0)
+                , benchmarkBaseline(0)
+                , perfCounters(0)
+                , capturedEvents(0)
+                , watchdog(0)
+                , currentTestTimeout(0)
+                , useColors(false) {
+            currentTest                           = 0;
+            numAssertionsForCurrentTestcase       = 0;
+            numFailedAssertionsForCurrentTestcase = 0;
+            lastAssertFile                        = 0;
+            lastAssertLine                        = 0;
             resetRunData();
         }
     };
@@ -1235,66 +2016,103 @@ namespace detail
 } // namespace detail
 
 String::String(const char* in) {
-    m_str = static_cast<char*>(malloc(detail::my_strlen(in) + 1));
-    strcpy(m_str, in);
+    unsigned in_len = static_cast<unsigned>(detail::my_strlen(in));
+    if(in_len <= last) {
+        memcpy(buf, in, in_len + 1);
+        setLast(last - in_len);
+    } else {
+        setOnHeap();
+        data.size     = in_len;
+        data.capacity = data.size + 1;
+        data.ptr      = static_cast<char*>(malloc(data.capacity));
+        memcpy(data.ptr, in, in_len + 1);
+    }
 }
 
-String::String(const String& other)
-        : m_str(0) {
-    copy(other);
-}
+String::String(const String& other) { copy(other); }
 
+// expects that this string doesn't own a heap buffer
 void String::copy(const String& other) {
-    if(m_str)
-        free(m_str);
-    m_str = 0;
-
-    if(other.m_str) {
-        m_str = static_cast<char*>(malloc(detail::my_strlen(other.m_str) + 1));
-        strcpy(m_str, other.m_str);
+    if(other.isOnStack()) {
+        memcpy(buf, other.buf, len);
+    } else {
+        setOnHeap();
+        data.size     = other.data.size;
+        data.capacity = data.size + 1;
+        data.ptr      = static_cast<char*>(malloc(data.capacity));
+        memcpy(data.ptr, other.data.ptr, data.size + 1);
     }
 }
 
 String::~String() {
-    if(m_str)
-        free(m_str);
+    if(!isOnStack())
+        free(data.ptr);
 }
 
 String& String::operator=(const String& other) {
-    if(this != &other)
-        copy(other);
+    if(this != &other) {
+        // reuse the heap buffer if the other string fits in it
+        if(!isOnStack() && !other.isOnStack() && data.capacity > other.data.size) {
+            data.size = other.data.size;
+            memcpy(data.ptr, other.data.ptr, data.size + 1);
+        } else {
+            if(!isOnStack())
+                free(data.ptr);
+            copy(other);
+        }
+    }
     return *this;
 }
 
-String String::operator+(const String& other) const { return String(m_str) += other; }
+String String::operator+(const String& other) const { return String(*this) += other; }
 
 String& String::operator+=(const String& other) {
-    using namespace detail;
-    if(m_str == 0) {
-        copy(other);
-    } else if(other.m_str != 0) {
-        char* newStr = static_cast<char*>(malloc(my_strlen(m_str) + my_strlen(other.m_str) + 1));
-        strcpy(newStr, m_str);
-        strcpy(newStr + my_strlen(m_str), other.m_str);
-        free(m_str);
-        m_str = newStr;
+    unsigned my_old_size = size();
+    unsigned other_size  = other.size();
+    unsigned total_size  = my_old_size + other_size;
+    if(isOnStack()) {
+        if(total_size < len) {
+            // memmove because the other string might be this one
+            memmove(buf + my_old_size, other.c_str(), other_size);
+            buf[total_size] = '\0';
+            setLast(last - total_size);
+            return *this;
+        }
+        // move to the heap - with room for growth
+        unsigned capacity = total_size * 2 + 1;
+        char*    temp     = static_cast<char*>(malloc(capacity));
+        memcpy(temp, buf, my_old_size);
+        setOnHeap();
+        data.ptr      = temp;
+        data.capacity = capacity;
+    } else if(data.capacity <= total_size) {
+        // grow geometrically so a series of appends is linear
+        data.capacity = detail::my_max(data.capacity * 2, total_size + 1);
+        data.ptr      = static_cast<char*>(realloc(data.ptr, data.capacity));
     }
+    // after moving to the heap or reallocating - other.c_str() is data.ptr if other is this
+    memcpy(data.ptr + my_old_size, other.c_str(), other_size);
+    data.ptr[total_size] = '\0';
+    data.size            = total_size;
     return *this;
 }
 
-unsigned String::size() const { return m_str ? detail::my_strlen(m_str) : 0; }
+unsigned String::size() const {
+    if(isOnStack())
+        return last - static_cast<unsigned>(buf[last]);
+    return data.size;
+}
+
 unsigned String::length() const { return size(); }
 
 int String::compare(const char* other, bool no_case) const {
     if(no_case)
-        return detail::stricmp(m_str, other);
-    return strcmp(m_str, other);
+        return detail::stricmp(c_str(), other);
+    return strcmp(c_str(), other);
 }
 
 int String::compare(const String& other, bool no_case) const {
-    if(no_case)
-        return detail::stricmp(m_str, other.m_str);
-    return strcmp(m_str, other.m_str);
+    return compare(other.c_str(), no_case);
 }
 
 std::ostream& operator<<(std::ostream& stream, const String& in) {
@@ -1398,8 +2216,14 @@ Context::~Context() {}
 void Context::addFilter(const char*, const char*) {}
 void Context::setOption(const char*, int) {}
 void Context::setOption(const char*, const char*) {}
+void Context::addReporter(IReporter*) {}
 bool Context::shouldExit() { return false; }
 int  Context::run() { return 0; }
+namespace detail
+{
+    void pauseAllocationTracking() {}
+    void resumeAllocationTracking() {}
+} // namespace detail
 } // namespace doctest
 #else // DOCTEST_CONFIG_DISABLE
 
@@ -1417,20 +2241,25 @@ int  Context::run() { return 0; }
     do {                                                                                           \
         if(buffer[0] != 0) {                                                                       \
             doctest::detail::Color col(color);                                                     \
-            printf("%s", buffer);                                                                  \
+            doctest::detail::writeOutput(buffer);                                                  \
         }                                                                                          \
     } while(doctest::detail::always_false())
 
-// the number of buckets used for the hash set
-#if !defined(DOCTEST_HASH_TABLE_NUM_BUCKETS)
-#define DOCTEST_HASH_TABLE_NUM_BUCKETS 1024
-#endif // DOCTEST_HASH_TABLE_NUM_BUCKETS
-
 // the buffer size used for snprintf() calls
 #if !defined(DOCTEST_SNPRINTF_BUFFER_LENGTH)
 #define DOCTEST_SNPRINTF_BUFFER_LENGTH 1024
 #endif // DOCTEST_SNPRINTF_BUFFER_LENGTH
 
+// the size of the buffer in which the output is assembled before it is handed to stdout
+#if !defined(DOCTEST_OUTPUT_BUFFER_LENGTH)
+#define DOCTEST_OUTPUT_BUFFER_LENGTH 16384
+#endif // DOCTEST_OUTPUT_BUFFER_LENGTH
+
+// the size of the ring buffer for the events of --dt-async-reporters - should be a power of 2
+#if !defined(DOCTEST_ASYNC_REPORTERS_BUFFER_LENGTH)
+#define DOCTEST_ASYNC_REPORTERS_BUFFER_LENGTH (1 << 20)
+#endif // DOCTEST_ASYNC_REPORTERS_BUFFER_LENGTH
+
 #if defined(_MSC_VER) || defined(__MINGW32__)
 extern "C" __declspec(dllimport) void __stdcall OutputDebugStringA(const char*);
 extern "C" __declspec(dllimport) int __stdcall IsDebuggerPresent();
@@ -1440,7 +2269,45 @@ extern "C" __declspec(dllimport) int __stdcall IsDebuggerPresent();
 #include <unistd.h>
 #endif // DOCTEST_CONFIG_COLORS_ANSI
 
-#ifdef DOCTEST_CONFIG_COLORS_WINDOWS
+#if !defined(DOCTEST_CONFIG_NO_MULTITHREADING) && !defined(DOCTEST_PLATFORM_WINDOWS)
+#include <pthread.h>
+#endif // DOCTEST_CONFIG_NO_MULTITHREADING && DOCTEST_PLATFORM_WINDOWS
+
+// for executing tests in worker processes with --dt-workers
+#ifndef DOCTEST_PLATFORM_WINDOWS
+#include <cerrno>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif // DOCTEST_PLATFORM_WINDOWS
+
+// for measuring the durations of tests
+#ifndef DOCTEST_PLATFORM_WINDOWS
+#include <sys/time.h>
+#endif // DOCTEST_PLATFORM_WINDOWS
+
+// for counting hardware events with --dt-perf-counters
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif // __linux__
+
+// for ending the processes of --dt-fork-subcases along with the one executing the test
+#if defined(__linux__)
+#include <sys/prctl.h>
+#endif // __linux__
+
+// thread local storage for the state of the tests being ran - each --dt-jobs worker has its own
+#if defined(DOCTEST_CONFIG_NO_MULTITHREADING)
+#define DOCTEST_THREAD_LOCAL
+#elif defined(_MSC_VER)
+#define DOCTEST_THREAD_LOCAL __declspec(thread)
+#else // _MSC_VER
+#define DOCTEST_THREAD_LOCAL __thread
+#endif // _MSC_VER
+
+#if defined(DOCTEST_CONFIG_COLORS_WINDOWS) || defined(DOCTEST_PLATFORM_WINDOWS)
 
 // defines for a leaner windows.h
 #ifndef WIN32_MEAN_AND_LEAN
@@ -1460,7 +2327,7 @@ extern "C" __declspec(dllimport) int __stdcall IsDebuggerPresent();
 #include <windows.h>
 #endif
 
-#endif // DOCTEST_CONFIG_COLORS_WINDOWS
+#endif // DOCTEST_CONFIG_COLORS_WINDOWS || DOCTEST_PLATFORM_WINDOWS
 
 namespace doctest
 {
@@ -1536,15 +2403,6 @@ namespace detail
         return hash;
     }
 
-    // checks if the name matches any of the filters (and can be configured what to do when empty)
-    int matchesAny(const char* name, Vector<String> filters, int matchEmpty, bool caseSensitive) {
-        if(filters.size() == 0 && matchEmpty)
-            return 1;
-        for(unsigned i = 0; i < filters.size(); ++i)
-            if(wildcmp(name, filters[i].c_str(), caseSensitive))
-                return 1;
-        return 0;
-    }
 
     template <class T>
     Vector<T>::Vector()
@@ -1635,87 +2493,950 @@ namespace detail
             m_size = num;
         } else {
             if(num > m_capacity) {
-                if(m_capacity == 0) {
-                    m_buffer = static_cast<T*>(malloc(sizeof(T) * num));
-                } else {
-                    T* temp = static_cast<T*>(malloc(sizeof(T) * num));
-                    for(unsigned i = 0; i < m_size; ++i) {
-                        new(temp + i) T(m_buffer[i]);
-                        (*(m_buffer + i)).~T();
-                    }
+                // grow geometrically so appending through resize() is amortized
+                m_capacity = my_max(num, m_capacity * 2);
+                T* temp    = static_cast<T*>(malloc(sizeof(T) * m_capacity));
+                for(unsigned i = 0; i < m_size; ++i) {
+                    new(temp + i) T(m_buffer[i]);
+                    (*(m_buffer + i)).~T();
                 }
-
-                for(unsigned i = m_size; i < num; ++i)
-                    new(m_buffer + i) T(val);
-
-                m_size     = num;
-                m_capacity = num;
+                free(m_buffer);
+                m_buffer = temp;
             }
-        }
-    }
 
-    template <>
-    unsigned Hash(const Subcase& in) {
-        return hashStr(reinterpret_cast<unsigned const char*>(in.m_file)) ^ in.m_line;
+            for(unsigned i = m_size; i < num; ++i)
+                new(m_buffer + i) T(val);
+            m_size = num;
+        }
     }
 
-    template <>
     unsigned Hash(const String& in) {
         return hashStr(reinterpret_cast<unsigned const char*>(in.c_str()));
     }
 
-    template <>
-    unsigned Hash(const int& in) {
-        return in;
+    unsigned Hash(const CachedMatch& in) {
+        return static_cast<unsigned>(reinterpret_cast<size_t>(in.str));
     }
 
-    // the current ContextState with which tests are being executed
-    ContextState*& getContextState() {
-        static ContextState* data = 0;
-        return data;
-    }
+    // a list of wildcard filters compiled once for matching many strings against all of them.
+    // Most filters are exact names or have a single '*' at the start or the end - those are
+    // looked up in hash sets (one lookup per distinct prefix/suffix length) and only the rest go
+    // through wildcmp(). The results can be cached by the address of the string - many tests
+    // share the same file and suite strings
+    class Filter
+    {
+        bool                   m_matchEmpty;    // the result when there are no filters
+        bool                   m_caseSensitive; // if not - the filters and names are lowercased
+        bool                   m_matchAll;      // if there is a "*" filter
+        unsigned               m_numFilters;    // the total number of filters
+        HashTable<String>      m_exact;         // filters without wildcards
+        HashTable<String>      m_prefixes;      // filters like "abc*"
+        HashTable<String>      m_suffixes;      // filters like "*abc"
+        Vector<unsigned>       m_prefixLengths; // the distinct lengths of the prefixes
+        Vector<unsigned>       m_suffixLengths; // the distinct lengths of the suffixes
+        Vector<String>         m_wildcards;     // all other filters - matched with wildcmp()
+        HashTable<CachedMatch> m_cache;         // the results for strings by their address
+
+        String normalize(const char* in) const {
+            String res(in);
+            if(!m_caseSensitive)
+                for(unsigned i = 0; i < res.size(); ++i)
+                    res[i] = tolower(res[i]);
+            return res;
+        }
 
-    TestAccessibleContextState* getTestsContextState() { return getContextState(); }
+        static void addLength(Vector<unsigned>& lengths, unsigned len) {
+            for(unsigned i = 0; i < lengths.size(); ++i)
+                if(lengths[i] == len)
+                    return;
+            lengths.push_back(len);
+        }
+
+        // checks the part of 'name' with length 'len' starting at 'start' against a set
+        static bool hasPart(const HashTable<String>& set, String& name, unsigned start,
+                            unsigned len) {
+            char saved        = name[start + len];
+            name[start + len] = '\0';
+            bool res          = set.has(String(name.c_str() + start));
+            name[start + len] = saved;
+            return res;
+        }
+
+    public:
+        Filter(const Vector<String>& filters, bool caseSensitive, bool matchEmpty)
+                : m_matchEmpty(matchEmpty)
+                , m_caseSensitive(caseSensitive)
+                , m_matchAll(false)
+                , m_numFilters(filters.size())
+                , m_exact(16)
+                , m_prefixes(16)
+                , m_suffixes(16)
+                , m_cache(16) {
+            for(unsigned i = 0; i < filters.size(); ++i) {
+                String      filter = normalize(filters[i].c_str());
+                const char* str    = filter.c_str();
+                unsigned    len    = filter.size();
+
+                // count the wildcards and find where the stars are
+                unsigned numStars = 0;
+                bool     hasQmark = false;
+                for(unsigned k = 0; k < len; ++k) {
+                    numStars += str[k] == '*' ? 1 : 0;
+                    hasQmark = hasQmark || str[k] == '?';
+                }
+
+                if(numStars == len && len > 0) {
+                    m_matchAll = true;
+                } else if(numStars == 0 && !hasQmark) {
+                    m_exact.insert(filter);
+                } else if(numStars == 1 && !hasQmark && str[len - 1] == '*') {
+                    filter[len - 1] = '\0';
+                    m_prefixes.insert(String(filter.c_str()));
+                    addLength(m_prefixLengths, len - 1);
+                } else if(numStars == 1 && !hasQmark && str[0] == '*') {
+                    m_suffixes.insert(String(str + 1));
+                    addLength(m_suffixLengths, len - 1);
+                } else {
+                    m_wildcards.push_back(filter);
+                }
+            }
+        }
+
+        bool matches(const char* in) const {
+            if(m_numFilters == 0)
+                return m_matchEmpty;
+            if(m_matchAll)
+                return true;
+
+            String   name = normalize(in);
+            unsigned len  = name.size();
+            if(m_exact.has(name))
+                return true;
+            for(unsigned i = 0; i < m_prefixLengths.size(); ++i)
+                if(m_prefixLengths[i] <= len && hasPart(m_prefixes, name, 0, m_prefixLengths[i]))
+                    return true;
+            for(unsigned i = 0; i < m_suffixLengths.size(); ++i)
+                if(m_suffixLengths[i] <= len &&
+                   hasPart(m_suffixes, name, len - m_suffixLengths[i], m_suffixLengths[i]))
+                    return true;
+            for(unsigned i = 0; i < m_wildcards.size(); ++i)
+                if(wildcmp(name.c_str(), m_wildcards[i].c_str(), true))
+                    return true;
+            return false;
+        }
+
+        // for strings shared by many tests (files and suites) - the result for each is cached
+        bool matchesCached(const char* in) {
+            CachedMatch        key    = {in, false};
+            const CachedMatch* cached = m_cache.find(key);
+            if(cached)
+                return cached->matches;
+            key.matches = matches(in);
+            m_cache.insert(key);
+            return key.matches;
+        }
+    };
+
+    // the current ContextState with which tests are being executed
+    ContextState*& getContextState() {
+        static DOCTEST_THREAD_LOCAL ContextState* data = 0;
+        return data;
+    }
+
+    TestAccessibleContextState* getTestsContextState() { return getContextState(); }
+
+    // the allocations with operator new of the thread executing a test - they are counted only
+    // while the test function is executing (and tracking isn't paused)
+    struct AllocationCounters
+    {
+        unsigned epoch;     // of the current test function (0 when not executing one)
+        unsigned lastEpoch; // so the blocks of the previous test functions can be told apart
+        int      paused;
+        unsigned count;
+        size_t   bytes;
+        size_t   live;
+        size_t   peak;
+    };
+
+    AllocationCounters& getAllocationCounters() {
+        static DOCTEST_THREAD_LOCAL AllocationCounters counters;
+        return counters;
+    }
+
+    void pauseAllocationTracking() { getAllocationCounters().paused++; }
+    void resumeAllocationTracking() { getAllocationCounters().paused--; }
+
+    void startAllocationTracking() {
+        AllocationCounters& c = getAllocationCounters();
+        if(++c.lastEpoch == 0) // 0 is for not executing a test function
+            ++c.lastEpoch;
+        c.epoch  = c.lastEpoch;
+        c.paused = 0;
+        c.count  = 0;
+        c.bytes  = 0;
+        c.live   = 0;
+        c.peak   = 0;
+    }
+
+    // converts a number of bytes to the type of TestCaseStats - a template so the cast isn't
+    // a useless one (-Wuseless-cast) where size_t is the same type
+    template <typename T>
+    T toStatsBytes(size_t bytes) {
+        return static_cast<T>(bytes);
+    }
+
+    void stopAllocationTracking(TestCaseStats& stats) {
+        AllocationCounters& c      = getAllocationCounters();
+        c.epoch                    = 0;
+        stats.m_numAllocations     = c.count;
+        stats.m_allocatedBytes     = toStatsBytes<unsigned long>(c.bytes);
+        stats.m_peakAllocatedBytes = toStatsBytes<unsigned long>(c.peak);
+    }
+
+#if defined(DOCTEST_CONFIG_TRACK_ALLOCATIONS)
+    // in front of each block allocated with operator new - the size of the header keeps the
+    // alignment of malloc()
+    union AllocationHeader
+    {
+        struct Info
+        {
+            size_t   size;
+            unsigned epoch; // of the test function which allocated it - 0 if it isn't counted
+        } info;
+        char padding[16];
+    };
+
+    void* allocate(size_t size) {
+        // the size with the header would wrap around
+        if(size > std::numeric_limits<size_t>::max() - sizeof(AllocationHeader))
+            return 0;
+        AllocationHeader* header =
+                static_cast<AllocationHeader*>(malloc(sizeof(AllocationHeader) + size));
+        if(!header)
+            return 0;
+        AllocationCounters& c = getAllocationCounters();
+        header->info.size     = size;
+        header->info.epoch    = c.paused > 0 ? 0 : c.epoch;
+        if(header->info.epoch != 0) {
+            c.count++;
+            c.bytes += size;
+            c.live += size;
+            c.peak = my_max(c.peak, c.live);
+        }
+        return header + 1;
+    }
+
+// to fix gcc "-Wmismatched-new-delete" warnings when inlined into the replaced operator delete
+#if defined(__GNUC__) && !defined(__clang__)
+    __attribute__((noinline))
+#endif
+    void
+    deallocate(void* ptr) {
+        if(!ptr)
+            return;
+        AllocationHeader*   header = static_cast<AllocationHeader*>(ptr) - 1;
+        AllocationCounters& c      = getAllocationCounters();
+        if(header->info.epoch != 0 && header->info.epoch == c.epoch)
+            c.live -= my_min(c.live, header->info.size);
+        free(header);
+    }
+#endif // DOCTEST_CONFIG_TRACK_ALLOCATIONS
+
+    // the names of the events for --dt-perf-counters - in the order of perfCounter::Enum
+    const char* const perfCounterNames[perfCounter::count] = {
+            "cycles",   "instructions",  "cache-references", "cache-misses",
+            "branches", "branch-misses", "page-faults",      "context-switches"};
+
+    // the counters of events for the calling thread - opened around a test function or the samples
+    // of a benchmark. They are in a group which the kernel schedules on the hardware as a whole so
+    // all of them count during the same time (and the values are scaled if the group had to share
+    // the hardware with other groups)
+    struct PerfCounters
+    {
+        int    fds[perfCounter::count]; // -1 for the events which aren't counted
+        double values[perfCounter::count];
+    };
+
+    // opens a counter for an event in the group of 'leader' (the group is created if it is -1) -
+    // returns -1 if the event can't be counted
+    int openPerfCounter(unsigned which, int leader) {
+#if defined(__linux__)
+        // clang-format off
+        static const unsigned types[perfCounter::count] = {
+            PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+            PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_SOFTWARE, PERF_TYPE_SOFTWARE};
+        static const unsigned configs[perfCounter::count] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_REFERENCES,
+            PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_INSTRUCTIONS,
+            PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_SW_PAGE_FAULTS, PERF_COUNT_SW_CONTEXT_SWITCHES};
+        // clang-format on
+
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size           = sizeof(attr);
+        attr.type           = types[which];
+        attr.config         = configs[which];
+        attr.disabled       = leader == -1 ? 1 : 0; // the whole group is enabled at once
+        attr.exclude_kernel = 1; // also works with the default perf_event_paranoid setting
+        attr.exclude_hv     = 1;
+        attr.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                           PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, leader, 0));
+#else  // __linux__
+        (void)which;
+        (void)leader;
+        return -1;
+#endif // __linux__
+    }
+
+    // opens the counters for the events in 'mask' (bits of perfCounter::Enum) and starts them
+    void startPerfCounters(PerfCounters& pc, unsigned mask) {
+        int leader = -1;
+        for(unsigned i = 0; i < perfCounter::count; ++i) {
+            pc.fds[i]    = (mask & (1u << i)) ? openPerfCounter(i, leader) : -1;
+            pc.values[i] = -1;
+            if(leader == -1)
+                leader = pc.fds[i];
+        }
+#if defined(__linux__)
+        if(leader != -1) {
+            ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif // __linux__
+    }
+
+    // stops the counters, reads them into 'values' and closes them (so it can be called again)
+    void stopPerfCounters(PerfCounters& pc) {
+#if defined(__linux__)
+        unsigned leader = 0;
+        while(leader < perfCounter::count && pc.fds[leader] == -1)
+            ++leader;
+        if(leader == perfCounter::count)
+            return;
+
+        // the number of events, the times the group was enabled and running and then the values
+        // in the order in which the counters were opened
+        ioctl(pc.fds[leader], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        __u64 data[3 + perfCounter::count];
+        bool  isRead  = read(pc.fds[leader], data, sizeof(data)) > 0 && data[2] > 0;
+        double scale  = isRead ? static_cast<double>(data[1]) / static_cast<double>(data[2]) : 0;
+        unsigned next = 3;
+        for(unsigned i = leader; i < perfCounter::count; ++i) {
+            if(pc.fds[i] == -1)
+                continue;
+            if(isRead)
+                pc.values[i] = static_cast<double>(data[next++]) * scale;
+            close(pc.fds[i]);
+            pc.fds[i] = -1;
+        }
+#else  // __linux__
+        (void)pc;
+#endif // __linux__
+    }
+
+    // the types of the events for reporters
+    namespace reporterEvent
+    {
+        enum Enum
+        {
+            wrap = 0, // not an event - marks that the records continue from the start of the ring
+            testCaseStart,
+            testCaseReenter,
+            testCaseIterationEnd,
+            testCaseEnd,
+            testCaseCrashed,
+            subcaseStart,
+            subcaseEnd,
+            logAssert,
+            logBenchmark,
+            runEnd
+        };
+    } // namespace reporterEvent
+
+    // an event for reporters as a flat record - this is how events are copied into the ring
+    // buffer of --dt-async-reporters and captured by the workers of --dt-jobs and --dt-workers.
+    // The strings are pointers to literals (which are valid in forked workers too) except for the
+    // decomposition of asserts and the reason of crashes which are copied right after the record.
+    // The size is a multiple of 8
+    struct ReporterEvent
+    {
+        unsigned      type; // reporterEvent::Enum
+        unsigned      size; // of the whole record
+        TestCaseData  testCase;
+        SubcaseData   subcase;
+        AssertData    assertData;
+        BenchmarkData benchmark;
+        TestCaseStats testCaseStats;
+        RunStats      runStats;
+        const char*   reason; // for testCaseCrashed
+    };
+
+    ReporterEvent makeEvent(reporterEvent::Enum type) {
+        ReporterEvent e;
+        memset(&e, 0, sizeof(e));
+        e.type = type;
+        return e;
+    }
+
+    TestCaseData getTestCaseData(const TestData& data) {
+        TestCaseData tc;
+        tc.m_file  = data.m_file;
+        tc.m_line  = data.m_line;
+        tc.m_name  = data.m_name;
+        tc.m_suite = data.m_suite;
+        return tc;
+    }
+
+    // calculates the size of the record for an event (and stores it in the event)
+    unsigned setRecordSize(ReporterEvent& e) {
+        unsigned size = sizeof(ReporterEvent);
+        if(e.type == reporterEvent::logAssert)
+            size += static_cast<unsigned>(my_strlen(e.assertData.m_decomposition)) + 1;
+        if(e.type == reporterEvent::testCaseCrashed)
+            size += static_cast<unsigned>(my_strlen(e.reason)) + 1;
+        e.size = (size + 7) & ~7u;
+        return e.size;
+    }
+
+    // writes the record for an event - there should be 'e.size' bytes available
+    void writeRecord(char* dest, const ReporterEvent& e) {
+        memcpy(dest, &e, sizeof(ReporterEvent));
+        if(e.type == reporterEvent::logAssert)
+            strcpy(dest + sizeof(ReporterEvent), e.assertData.m_decomposition);
+        if(e.type == reporterEvent::testCaseCrashed)
+            strcpy(dest + sizeof(ReporterEvent), e.reason);
+    }
+
+    // reads an event from a record - the decomposition of asserts (or the reason of a crash)
+    // points inside the record
+    ReporterEvent readRecord(const char* src) {
+        ReporterEvent e;
+        memcpy(&e, src, sizeof(ReporterEvent));
+        if(e.type == reporterEvent::logAssert)
+            e.assertData.m_decomposition = src + sizeof(ReporterEvent);
+        if(e.type == reporterEvent::testCaseCrashed)
+            e.reason = src + sizeof(ReporterEvent);
+        return e;
+    }
+
+    unsigned readRecordType(const char* src) {
+        unsigned type;
+        memcpy(&type, src, sizeof(type));
+        return type;
+    }
+
+    void dispatchEvent(const Vector<IReporter*>& reporters, const ReporterEvent& e) {
+        for(unsigned i = 0; i < reporters.size(); ++i) {
+            IReporter* r = reporters[i];
+            // clang-format off
+            switch(e.type) {
+                case reporterEvent::testCaseStart:   r->testCaseStart(e.testCase);                    break;
+                case reporterEvent::testCaseReenter: r->testCaseReenter(e.testCase);                  break;
+                case reporterEvent::testCaseIterationEnd:
+                                                     r->testCaseIterationEnd(e.testCase, e.testCaseStats); break;
+                case reporterEvent::testCaseEnd:     r->testCaseEnd(e.testCase, e.testCaseStats);     break;
+                case reporterEvent::testCaseCrashed: r->testCaseCrashed(e.testCase, e.reason);        break;
+                case reporterEvent::subcaseStart:    r->subcaseStart(e.subcase);                      break;
+                case reporterEvent::subcaseEnd:      r->subcaseEnd(e.subcase);                        break;
+                case reporterEvent::logAssert:       r->logAssert(e.assertData);                      break;
+                case reporterEvent::logBenchmark:    r->logBenchmark(e.benchmark);                    break;
+                case reporterEvent::runEnd:          r->runEnd(e.runStats);                           break;
+                default: break;
+            }
+            // clang-format on
+        }
+    }
+
+    // loads and stores with acquire/release semantics - for the positions in the ring buffer
+    unsigned loadAcquire(const volatile unsigned& var) {
+#if defined(__ATOMIC_ACQUIRE)
+        return __atomic_load_n(&var, __ATOMIC_ACQUIRE);
+#elif defined(_MSC_VER)
+        unsigned res = var;
+        MemoryBarrier();
+        return res;
+#else  // __ATOMIC_ACQUIRE
+        unsigned res = var;
+        __sync_synchronize();
+        return res;
+#endif // __ATOMIC_ACQUIRE
+    }
+
+    void storeRelease(volatile unsigned& var, unsigned value) {
+#if defined(__ATOMIC_RELEASE)
+        __atomic_store_n(&var, value, __ATOMIC_RELEASE);
+#elif defined(_MSC_VER)
+        MemoryBarrier();
+        var = value;
+#else  // __ATOMIC_RELEASE
+        __sync_synchronize();
+        var = value;
+#endif // __ATOMIC_RELEASE
+    }
+
+    // orders the store before it with the load after it - for the flags of threads about to block
+    void fullBarrier() {
+#if defined(__ATOMIC_SEQ_CST)
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#elif defined(_MSC_VER)
+        MemoryBarrier();
+#else  // __ATOMIC_SEQ_CST
+        __sync_synchronize();
+#endif // __ATOMIC_SEQ_CST
+    }
+
+#ifndef DOCTEST_CONFIG_NO_MULTITHREADING
+    // wakes up a thread blocked in wait() - a signal() before the wait() is not lost (the next
+    // wait() returns right away)
+    class Signal
+    {
+#ifdef DOCTEST_PLATFORM_WINDOWS
+        HANDLE m_event;
+#else  // DOCTEST_PLATFORM_WINDOWS
+        pthread_mutex_t m_mutex;
+        pthread_cond_t  m_cond;
+        bool            m_signaled;
+#endif // DOCTEST_PLATFORM_WINDOWS
+
+        Signal(const Signal&);
+        Signal& operator=(const Signal&);
+
+    public:
+#ifdef DOCTEST_PLATFORM_WINDOWS
+        Signal()
+                : m_event(CreateEvent(0, FALSE, FALSE, 0)) {}
+        ~Signal() { CloseHandle(m_event); }
+        void signal() { SetEvent(m_event); }
+        void wait() { WaitForSingleObject(m_event, INFINITE); }
+#else  // DOCTEST_PLATFORM_WINDOWS
+        Signal()
+                : m_signaled(false) {
+            pthread_mutex_init(&m_mutex, 0);
+            pthread_cond_init(&m_cond, 0);
+        }
+        ~Signal() {
+            pthread_cond_destroy(&m_cond);
+            pthread_mutex_destroy(&m_mutex);
+        }
+        void signal() {
+            pthread_mutex_lock(&m_mutex);
+            m_signaled = true;
+            pthread_cond_signal(&m_cond);
+            pthread_mutex_unlock(&m_mutex);
+        }
+        void wait() {
+            pthread_mutex_lock(&m_mutex);
+            while(!m_signaled)
+                pthread_cond_wait(&m_cond, &m_mutex);
+            m_signaled = false;
+            pthread_mutex_unlock(&m_mutex);
+        }
+#endif // DOCTEST_PLATFORM_WINDOWS
+    };
+#else  // DOCTEST_CONFIG_NO_MULTITHREADING
+    // without threads there is no ring buffer between threads to wait on
+    class Signal
+    {
+    public:
+        void signal() {}
+        void wait() {}
+    };
+#endif // DOCTEST_CONFIG_NO_MULTITHREADING
+
+    // used by the workers while waiting for others which may have more work for them
+    void sleepBriefly() {
+#ifdef DOCTEST_PLATFORM_WINDOWS
+        Sleep(1);
+#else  // DOCTEST_PLATFORM_WINDOWS
+        timespec t;
+        t.tv_sec  = 0;
+        t.tv_nsec = 100000; // 0.1 ms
+        nanosleep(&t, 0);
+#endif // DOCTEST_PLATFORM_WINDOWS
+    }
+
+    // used by the watchdog of --dt-timeout between checking the deadlines of tests
+    void sleepMilliseconds(unsigned ms) {
+#ifdef DOCTEST_PLATFORM_WINDOWS
+        Sleep(ms);
+#else  // DOCTEST_PLATFORM_WINDOWS
+        timespec t;
+        t.tv_sec  = static_cast<time_t>(ms / 1000);
+        t.tv_nsec = static_cast<long>(ms % 1000) * 1000000;
+        nanosleep(&t, 0);
+#endif // DOCTEST_PLATFORM_WINDOWS
+    }
+
+    // a lock-free ring buffer of event records with a single producer (the thread executing tests)
+    // and a single consumer (the thread of --dt-async-reporters). The positions only grow (and
+    // wrap around as unsigned) - the size of the buffer is a power of 2
+    class EventRing
+    {
+        char*             m_data;
+        unsigned          m_size;
+        volatile unsigned m_head; // written only by the producer
+        volatile unsigned m_tail; // written only by the consumer
+        volatile unsigned m_done; // set by the producer after the last event
+
+        // a side which finds nothing to do blocks on a signal from the other one - it sets its
+        // flag first and checks again (after a full barrier) so the other side either sees the
+        // flag and signals or has already done what the blocked side was waiting for
+        volatile unsigned m_consumerWaits; // for an event
+        volatile unsigned m_producerWaits; // for free space (or for the buffer to be empty)
+        Signal            m_hasEvents;     // signaled by the producer
+        Signal            m_hasSpace;      // signaled by the consumer
+
+        EventRing(const EventRing&);
+        EventRing& operator=(const EventRing&);
+
+        bool hasSpace(unsigned head, unsigned needed) const {
+            return m_size - (head - loadAcquire(m_tail)) >= needed;
+        }
+
+        // blocks the producer until the consumer has made progress - at least once
+        void waitForConsumer() {
+            storeRelease(m_producerWaits, 1);
+            fullBarrier();
+            if(!empty())
+                m_hasSpace.wait();
+            storeRelease(m_producerWaits, 0);
+        }
+
+    public:
+        explicit EventRing(unsigned size)
+                : m_data(static_cast<char*>(malloc(size)))
+                , m_size(size)
+                , m_head(0)
+                , m_tail(0)
+                , m_done(0)
+                , m_consumerWaits(0)
+                , m_producerWaits(0) {}
+        ~EventRing() { free(m_data); }
+
+        // records that don't fit in half of the buffer should be reported differently
+        bool fits(const ReporterEvent& e) const { return e.size <= m_size / 2; }
+
+        // copies the record of an event in the buffer - waits while the buffer is full
+        void push(const ReporterEvent& e) {
+            unsigned head       = m_head;
+            unsigned pos        = head & (m_size - 1);
+            unsigned contiguous = m_size - pos;
+            unsigned needed     = e.size > contiguous ? e.size + contiguous : e.size;
+            while(!hasSpace(head, needed))
+                waitForConsumer();
+
+            // the record doesn't fit at the back - the rest of it is skipped by the consumer
+            if(e.size > contiguous) {
+                unsigned type = reporterEvent::wrap;
+                memcpy(m_data + pos, &type, sizeof(type));
+                head += contiguous;
+                pos = 0;
+            }
+            writeRecord(m_data + pos, e);
+            storeRelease(m_head, head + e.size);
+
+            fullBarrier();
+            if(loadAcquire(m_consumerWaits))
+                m_hasEvents.signal();
+        }
+
+        // returns the oldest record or null if the buffer is empty - to be followed by pop()
+        const char* front() {
+            for(;;) {
+                unsigned tail = m_tail;
+                if(tail == loadAcquire(m_head))
+                    return 0;
+                unsigned pos = tail & (m_size - 1);
+                if(readRecordType(m_data + pos) != reporterEvent::wrap)
+                    return m_data + pos;
+                storeRelease(m_tail, tail + m_size - pos);
+            }
+        }
+
+        void pop() {
+            storeRelease(m_tail, m_tail + readRecord(front()).size);
+
+            fullBarrier();
+            if(loadAcquire(m_producerWaits))
+                m_hasSpace.signal();
+        }
+
+        bool empty() const { return loadAcquire(m_tail) == loadAcquire(m_head); }
+
+        // blocks the consumer until there is an event (or the producer has finished)
+        void waitForEvents() {
+            storeRelease(m_consumerWaits, 1);
+            fullBarrier();
+            if(empty() && !finished())
+                m_hasEvents.wait();
+            storeRelease(m_consumerWaits, 0);
+        }
+
+        // blocks the producer until the consumer has processed all events
+        void waitUntilEmpty() {
+            while(!empty())
+                waitForConsumer();
+        }
+
+        void finish() {
+            storeRelease(m_done, 1);
+            m_hasEvents.signal();
+        }
+        bool finished() const { return loadAcquire(m_done) != 0; }
+    };
+
+    // the reporters of a run and the way the events reach them
+    struct Reporters
+    {
+        Vector<IReporter*> all;
+        EventRing*         ring; // set with --dt-async-reporters - the events go through it
+
+        Reporters()
+                : ring(0) {}
+
+        void report(const ReporterEvent& e) {
+            if(ring && ring->fits(e)) {
+                ring->push(e);
+                return;
+            }
+            // the reporters are called here only when the async thread is done with the rest
+            if(ring)
+                ring->waitUntilEmpty();
+            dispatchEvent(all, e);
+        }
+    };
+
+    // reports an event from the thread executing a test - or captures it if it is a worker
+    void reportEvent(ReporterEvent& e) {
+        ContextState* p = getContextState();
+        setRecordSize(e);
+        if(p->capturedEvents) {
+            Vector<char>& events = *p->capturedEvents;
+            unsigned      offset = events.size();
+            events.resize(offset + e.size);
+            writeRecord(events.data() + offset, e);
+        } else {
+            p->reporters->report(e);
+        }
+    }
+
+    // reports the events captured by a worker of --dt-jobs or --dt-workers
+    void replayEvents(Reporters& reporters, const Vector<char>& events) {
+        for(unsigned offset = 0; offset < events.size();) {
+            ReporterEvent e = readRecord(events.data() + offset);
+            reporters.report(e);
+            offset += e.size;
+        }
+    }
+
+    void reportSubcaseEvent(reporterEvent::Enum type, const Subcase& sc) {
+        ReporterEvent e  = makeEvent(type);
+        e.subcase.m_name = sc.m_name;
+        e.subcase.m_file = sc.m_file;
+        e.subcase.m_line = sc.m_line;
+        reportEvent(e);
+    }
+
+#ifndef DOCTEST_PLATFORM_WINDOWS
+    // with --dt-fork-subcases the subcases are entered by forked processes - defined along with
+    // the worker processes of --dt-workers
+    bool forkSubcase(ContextState* s, unsigned parent);
+    void sendSubcaseEvents(ContextState* s);
+    bool runSubcasesInProcesses(ContextState* p, const TestData& data, ReporterEvent& e,
+                                unsigned& didFail);
+#endif // DOCTEST_PLATFORM_WINDOWS
+
+    // starts the tree of subcases for a test - in the memory of the one of the previous test
+    void resetSubcaseTree(ContextState* s, const TestData& data) {
+        SubcaseNode root = {data.m_name, data.m_file, static_cast<int>(data.m_line), 0, 0, 0, 0, 0,
+                            0, 0, false, s->filters[6].size() == 0};
+        s->subcaseTree.clear();
+        s->subcaseTree.push_back(root);
+        s->subcasesRun = 0;
+    }
+
+    // starts a run of the test function - for the paths through its subcases not executed yet
+    void startSubcaseRun(ContextState* s) {
+        s->subcasesRun++;
+        s->subcasesCurrent     = 0;
+        s->subcasesHasSkipped  = false;
+        s->subcasesLastEntered = 0;
+    }
+
+    // matches the subcases on a path (the outermost first) from 'level' against the names of a
+    // filter from 'part' - a "**" stands for any number of subcases. Returns as matchSubcasePath()
+    int matchSubcaseParts(const ContextState* s, const Vector<unsigned>& path, unsigned level,
+                          const Vector<const char*>& parts, unsigned part) {
+        if(part == parts.size())
+            return 1;
+        if(strcmp(parts[part], "**") == 0) {
+            int res = matchSubcaseParts(s, path, level, parts, part + 1);
+            if(res == 1)
+                return 1;
+            if(level == path.size())
+                return 0; // the rest of the filter might match deeper
+            return my_max(res, matchSubcaseParts(s, path, level + 1, parts, part));
+        }
+        if(level == path.size())
+            return 0;
+        if(!wildcmp(s->subcaseTree[path[level]].name, parts[part], s->case_sensitive))
+            return -1;
+        return matchSubcaseParts(s, path, level + 1, parts, part + 1);
+    }
+
+    // matches the path of a subcase (the names of the subcases it is in and its own) against a
+    // filter with names separated by '/' - each name with its own wildcards. Returns 1 if the
+    // subcase (or one it is in) matches, 0 if the path is the start of the filter and -1 if not.
+    // The first name is for the outermost subcases - a filter starting with "**/" is for the
+    // subcases at any depth (so any subcase which doesn't match it might still lead to one)
+    int matchSubcasePath(const ContextState* s, unsigned node, const String& filter) {
+        Vector<unsigned> path(s->subcaseTree[node].depth);
+        for(unsigned i = node; i != 0; i = s->subcaseTree[i].parent)
+            path[s->subcaseTree[i].depth - 1] = i;
+
+        String              names(filter);
+        Vector<const char*> parts;
+        char*               part = names.c_str();
+        parts.push_back(part);
+        while((part = strchr(part, '/')) != 0) {
+            *part++ = '\0';
+            parts.push_back(part);
+        }
+        return matchSubcaseParts(s, path, 0, parts, 0);
+    }
+
+    // if a new subcase passes the --dt-subcase filters - the ones which don't are never entered.
+    // With include filters it has to match one of them, be in a subcase which did or lead to one
+    bool passesSubcaseFilters(ContextState* s, unsigned node) {
+        const Vector<String>& include = s->filters[6];
+        const Vector<String>& exclude = s->filters[7];
+        SubcaseNode&          sc      = s->subcaseTree[node];
+
+        bool leads = false;
+        sc.matched = s->subcaseTree[sc.parent].matched;
+        for(unsigned i = 0; i < include.size() && !sc.matched; ++i) {
+            int res    = matchSubcasePath(s, node, include[i]);
+            sc.matched = res == 1;
+            leads      = leads || res == 0;
+        }
+        if(!sc.matched && !leads)
+            return false;
+
+        for(unsigned i = 0; i < exclude.size(); ++i)
+            if(matchSubcasePath(s, node, exclude[i]) == 1)
+                return false;
+        return true;
+    }
+
+    // returns the child of a node of the tree of subcases for a location - added if not there yet
+    unsigned getSubcaseNode(ContextState* s, unsigned parent, const Subcase& sc) {
+        Vector<SubcaseNode>& tree = s->subcaseTree;
+
+        unsigned last    = 0;
+        unsigned ordinal = 0;
+        for(unsigned i = tree[parent].firstChild; i != 0; i = tree[i].nextSibling, ++ordinal) {
+            // __FILE__ is usually the same string literal so comparing the addresses is enough
+            const SubcaseNode& node = tree[i];
+            if(node.line == sc.m_line &&
+               (node.file == sc.m_file || strcmp(node.file, sc.m_file) == 0))
+                return i;
+            last = i;
+        }
+
+        SubcaseNode added = {sc.m_name, sc.m_file, sc.m_line, parent, tree[parent].depth + 1,
+                             ordinal, 0, 0, 0, 0, false, false};
+        tree.push_back(added);
+        unsigned node = tree.size() - 1;
+        if(last != 0)
+            tree[last].nextSibling = node;
+        else
+            tree[parent].firstChild = node;
+
+        // the ones filtered out are as good as passed - their bodies are never executed
+        tree[node].passed = !passesSubcaseFilters(s, node);
+        return node;
+    }
+
+    // the path to a subcase for a run of --dt-parallel-subcases - starting from the outermost one
+    Vector<SubcaseStep> getSubcasePath(const ContextState* s, unsigned node) {
+        const Vector<SubcaseNode>& tree = s->subcaseTree;
+
+        Vector<SubcaseStep> path(tree[node].depth);
+        for(unsigned i = node; i != 0; i = tree[i].parent) {
+            path[tree[i].depth - 1].file    = tree[i].file;
+            path[tree[i].depth - 1].line    = tree[i].line;
+            path[tree[i].depth - 1].ordinal = tree[i].ordinal;
+        }
+        return path;
+    }
 
     Subcase::Subcase(const char* name, const char* file, int line)
             : m_name(name)
             , m_file(file)
             , m_line(line)
             , m_entered(false) {
-        ContextState* s = getContextState();
+        ContextState* s      = getContextState();
+        unsigned      parent = s->subcasesCurrent;
+        unsigned      node   = getSubcaseNode(s, parent, *this);
 
-        // if we have already completed it
-        if(s->subcasesPassed.has(*this))
+        // if we have already completed it (or it is filtered out with --dt-subcase)
+        if(s->subcaseTree[node].passed)
             return;
 
-        // if a Subcase on the same level has already been entered
-        if(s->subcasesEnteredLevels.has(s->subcasesCurrentLevel)) {
-            s->subcasesHasSkipped = true;
+        unsigned depth = s->subcaseTree[parent].depth;
+        if(depth < s->subcasesPath.size()) {
+            // a run of --dt-parallel-subcases enters only the subcases on its path (to its end)
+            const SubcaseStep& step = s->subcasesPath[depth];
+            if(m_line != step.line || (m_file != step.file && strcmp(m_file, step.file) != 0)) {
+                // one after the subcase on the path is left for another run - as when serial
+                if(s->subcaseTree[parent].childEnteredRun == s->subcasesRun)
+                    s->subcasesHasSkipped = true;
+                return;
+            }
+        } else if(s->subcaseTree[parent].childEnteredRun == s->subcasesRun) {
+            // if a sibling has already been entered in this run - it is left for another one
+            if(s->subcasesSpawned) {
+                // ... which with --dt-parallel-subcases is a separate run starting from it
+                s->subcasesSpawned->push_back(getSubcasePath(s, node));
+                s->subcaseTree[node].passed = true;
+                s->subcasesHasSkipped       = true;
+                return;
+            }
+            s->subcaseTree[parent].unfinishedRun = s->subcasesRun;
+            s->subcasesHasSkipped                = true;
             return;
         }
 
-        s->subcasesStack.push_back(*this);
-        s->hasLoggedCurrentTestStart = false;
-        if(s->hasLoggedCurrentTestStart)
-            logTestEnd();
+#ifndef DOCTEST_PLATFORM_WINDOWS
+        // with --dt-fork-subcases this process waits here while a child enters the subcase
+        if(!forkSubcase(s, parent))
+            return;
+#endif // DOCTEST_PLATFORM_WINDOWS
 
-        s->subcasesEnteredLevels.insert(s->subcasesCurrentLevel++);
+        s->subcaseTree[parent].childEnteredRun = s->subcasesRun;
+        s->subcasesCurrent                     = node;
+        s->subcasesLastEntered                 = node;
+        reportSubcaseEvent(reporterEvent::subcaseStart, *this);
         m_entered = true;
+#ifndef DOCTEST_PLATFORM_WINDOWS
+        // right away - so a test which hangs in it (or a process which dies) is reported in it
+        sendSubcaseEvents(s);
+#endif // DOCTEST_PLATFORM_WINDOWS
     }
 
     Subcase::~Subcase() {
         if(m_entered) {
-            ContextState* s = getContextState();
+            ContextState* s    = getContextState();
+            SubcaseNode&  node = s->subcaseTree[s->subcasesCurrent];
 
-            s->subcasesCurrentLevel--;
-            // only mark the subcase as passed if no subcases have been skipped
-            if(s->subcasesHasSkipped == false)
-                s->subcasesPassed.insert(*this);
+            // it is passed if none of the subcases inside of it were left for another run
+            node.passed        = node.unfinishedRun != s->subcasesRun;
+            s->subcasesCurrent = node.parent;
+            if(!node.passed)
+                s->subcaseTree[node.parent].unfinishedRun = s->subcasesRun;
 
-            s->subcasesStack.pop_back();
-            s->hasLoggedCurrentTestStart = false;
-            if(s->hasLoggedCurrentTestStart)
-                logTestEnd();
+            reportSubcaseEvent(reporterEvent::subcaseEnd, *this);
         }
     }
 
@@ -1733,14 +3454,6 @@ namespace detail
         return *this;
     }
 
-    bool Subcase::operator==(const Subcase& other) const {
-        return m_line == other.m_line && strcmp(m_file, other.m_file) == 0;
-    }
-
-    unsigned Hash(const TestData& in) {
-        return hashStr(reinterpret_cast<unsigned const char*>(in.m_file)) ^ in.m_line;
-    }
-
     // for sorting tests by file/line
     int fileOrderComparator(const void* a, const void* b) {
         const TestData* lhs = *static_cast<TestData* const*>(a);
@@ -1791,18 +3504,61 @@ namespace detail
         return 0;
     }
 
-    // all the registered tests
-    HashTable<TestData>& getRegisteredTests() {
-        static HashTable<TestData> data(DOCTEST_HASH_TABLE_NUM_BUCKETS);
+    // the head of the intrusive list of all registered tests (in reverse order of registration)
+    TestData*& getRegisteredTests() {
+        static TestData* data = 0;
         return data;
     }
 
-    // used by the macros for registering tests
-    int regTest(funcType f, unsigned line, const char* file, const char* name) {
-        getRegisteredTests().insert(TestData(getCurrentTestSuite(), name, f, file, line));
+    // used by the macros for registering tests - duplicates are removed when the tests are ran
+    int regTest(TestData* data) {
+        data->m_suite        = getCurrentTestSuite();
+        data->m_next         = getRegisteredTests();
+        getRegisteredTests() = data;
         return 0;
     }
 
+    // the output is assembled here and handed to stdout in big chunks instead of one printf() for
+    // each colored fragment - each thread has its own so worker threads don't need to lock
+    struct OutputBuffer
+    {
+        char     data[DOCTEST_OUTPUT_BUFFER_LENGTH];
+        unsigned size;
+    };
+
+    OutputBuffer& getOutputBuffer() {
+        static DOCTEST_THREAD_LOCAL OutputBuffer buffer;
+        return buffer;
+    }
+
+    // hands the buffered output to stdout - done after each logged event so it stays in order with
+    // what the tests themselves print - and flushes stdout itself if told so (at test boundaries)
+    void flushOutput(bool toDevice) {
+        OutputBuffer& buffer = getOutputBuffer();
+        if(buffer.size) {
+            fwrite(buffer.data, 1, buffer.size, stdout);
+            buffer.size = 0;
+        }
+        if(toDevice)
+            fflush(stdout);
+    }
+
+    void bufferOutput(const char* text, unsigned len) {
+        OutputBuffer& buffer = getOutputBuffer();
+        if(buffer.size + len > DOCTEST_OUTPUT_BUFFER_LENGTH)
+            flushOutput(false);
+        if(len > DOCTEST_OUTPUT_BUFFER_LENGTH) {
+            fwrite(text, 1, len, stdout);
+            return;
+        }
+        memcpy(buffer.data + buffer.size, text, len);
+        buffer.size += len;
+    }
+
+    void writeOutput(const char* text) {
+        bufferOutput(text, static_cast<unsigned>(my_strlen(text)));
+    }
+
     struct Color
     {
         enum Code
@@ -1838,31 +3594,29 @@ namespace detail
 #endif // DOCTEST_CONFIG_COLORS_NONE
                     ) {
         ContextState* p = getContextState();
-        if(p->no_colors)
+        if(!p->useColors)
             return;
 #ifdef DOCTEST_CONFIG_COLORS_ANSI
-        if(isatty(STDOUT_FILENO)) {
-            const char* col = "";
-            // clang-format off
-            switch(code) {
-                case Color::Red:         col = "[0;31m"; break;
-                case Color::Green:       col = "[0;32m"; break;
-                case Color::Blue:        col = "[0:34m"; break;
-                case Color::Cyan:        col = "[0;36m"; break;
-                case Color::Yellow:      col = "[0;33m"; break;
-                case Color::Grey:        col = "[1;30m"; break;
-                case Color::LightGrey:   col = "[0;37m"; break;
-                case Color::BrightRed:   col = "[1;31m"; break;
-                case Color::BrightGreen: col = "[1;32m"; break;
-                case Color::BrightWhite: col = "[1;37m"; break;
-                case Color::Bright: // invalid
-                case Color::None:
-                case Color::White:
-                default:                 col = "[0m";
-            }
-            // clang-format on
-            printf("\033%s", col);
+        const char* col = "";
+        // clang-format off
+        switch(code) {
+            case Color::Red:         col = "\033[0;31m"; break;
+            case Color::Green:       col = "\033[0;32m"; break;
+            case Color::Blue:        col = "\033[0:34m"; break;
+            case Color::Cyan:        col = "\033[0;36m"; break;
+            case Color::Yellow:      col = "\033[0;33m"; break;
+            case Color::Grey:        col = "\033[1;30m"; break;
+            case Color::LightGrey:   col = "\033[0;37m"; break;
+            case Color::BrightRed:   col = "\033[1;31m"; break;
+            case Color::BrightGreen: col = "\033[1;32m"; break;
+            case Color::BrightWhite: col = "\033[1;37m"; break;
+            case Color::Bright: // invalid
+            case Color::None:
+            case Color::White:
+            default:                 col = "\033[0m";
         }
+        // clang-format on
+        writeOutput(col);
 #endif // DOCTEST_CONFIG_COLORS_ANSI
 
 #ifdef DOCTEST_CONFIG_COLORS_WINDOWS
@@ -1882,6 +3636,9 @@ namespace detail
                     ~(FOREGROUND_GREEN | FOREGROUND_RED | FOREGROUND_BLUE | FOREGROUND_INTENSITY);
         }
 
+        // what has been buffered so far should be printed with the previous attributes
+        flushOutput(true);
+
 #define DOCTEST_SET_ATTR(x) SetConsoleTextAttribute(stdoutHandle, x | originalBackgroundAttributes)
 
         // clang-format off
@@ -1914,8 +3671,10 @@ namespace detail
             if(getContextState()->numFailedAssertionsForCurrentTestcase)
                 res = EXIT_FAILURE;
         } catch(const TestFailureException&) { res = EXIT_FAILURE; } catch(...) {
-            DOCTEST_LOG_START();
-            logTestCrashed();
+            ReporterEvent e = makeEvent(reporterEvent::testCaseCrashed);
+            e.testCase      = getTestCaseData(*getContextState()->currentTest);
+            e.reason        = "threw exception";
+            reportEvent(e);
             res = EXIT_FAILURE;
         }
         return res;
@@ -1995,337 +3754,3859 @@ namespace detail
         }
     }
 
-    void logTestStart(const char* name, const char* file, unsigned line) {
-        const char* newLine = "\n";
-
-        char loc[DOCTEST_SNPRINTF_BUFFER_LENGTH];
-        DOCTEST_SNPRINTF(loc, DOCTEST_COUNTOF(loc), "%s(%d)\n", fileForOutput(file), line);
+    void reportAssert(AssertData::Kind kind, bool passed, const char* assert_name,
+                      const char* file, int line, const char* expr, bool threw, bool threw_as,
+                      const char* exception_type, const char* decomposition) {
+        ReporterEvent e = makeEvent(reporterEvent::logAssert);
+
+        e.assertData.m_kind          = kind;
+        e.assertData.m_passed        = passed;
+        e.assertData.m_assertName    = assert_name;
+        e.assertData.m_file          = file;
+        e.assertData.m_line          = line;
+        e.assertData.m_expr          = expr;
+        e.assertData.m_threw         = threw;
+        e.assertData.m_threwAs       = threw_as;
+        e.assertData.m_exceptionType = exception_type;
+        e.assertData.m_decomposition = decomposition;
+        reportEvent(e);
+    }
 
-        char msg[DOCTEST_SNPRINTF_BUFFER_LENGTH];
-        DOCTEST_SNPRINTF(msg, DOCTEST_COUNTOF(msg), "%s\n", name);
+    void logAssert(bool passed, const char* decomposition, bool threw, const char* expr,
+                   const char* assert_name, const char* file, int line) {
+        reportAssert(AssertData::Normal, passed, assert_name, file, line, expr, threw, false, "",
+                     threw ? "" : decomposition);
+    }
 
-        DOCTEST_PRINTF_COLORED(getSeparator(), Color::Yellow);
-        DOCTEST_PRINTF_COLORED(loc, Color::LightGrey);
-        DOCTEST_PRINTF_COLORED(msg, Color::None);
+    void logAssertThrows(bool threw, const char* expr, const char* assert_name, const char* file,
+                         int line) {
+        reportAssert(AssertData::Throws, threw, assert_name, file, line, expr, threw, false, "",
+                     "");
+    }
 
-        String           subcaseStuff  = "";
-        Vector<Subcase>& subcasesStack = getContextState()->subcasesStack;
-        String           tabulation;
-        for(unsigned i = 0; i < subcasesStack.size(); ++i) {
-            tabulation += "  ";
-            char subcase[DOCTEST_SNPRINTF_BUFFER_LENGTH];
-            DOCTEST_SNPRINTF(subcase, DOCTEST_COUNTOF(loc), "%s%s\n", tabulation.c_str(),
-                             subcasesStack[i].m_name);
-            DOCTEST_PRINTF_COLORED(subcase, Color::None);
-            subcaseStuff += subcase;
-        }
+    void logAssertThrowsAs(bool threw, bool threw_as, const char* as, const char* expr,
+                           const char* assert_name, const char* file, int line) {
+        reportAssert(AssertData::ThrowsAs, threw_as, assert_name, file, line, expr, threw,
+                     threw_as, as, "");
+    }
 
-        DOCTEST_PRINTF_COLORED(newLine, Color::None);
+    void logAssertNothrow(bool threw, const char* expr, const char* assert_name, const char* file,
+                          int line) {
+        reportAssert(AssertData::Nothrow, !threw, assert_name, file, line, expr, threw, false, "",
+                     "");
+    }
 
-        printToDebugConsole(String(getSeparator()) + loc + msg + subcaseStuff.c_str() + newLine);
+    bool logBinaryAssert(bool passed, const String& decomposition, bool threw, const char* expr,
+                         const char* assert_name, const char* file, int line) {
+        if(!passed || getContextState()->success)
+            logAssert(passed, decomposition.c_str(), threw, expr, assert_name, file, line);
+        getContextState()->numAssertionsForCurrentTestcase++;
+        if(passed)
+            return false;
+        addFailedAssert(assert_name);
+        return true;
     }
 
-    void logTestEnd() {}
+    // the unit in which a duration (in seconds) is printed - and the factor for converting to it
+    const char* getDurationUnit(double seconds, double& scale) {
+        if(seconds < 1e-6) {
+            scale = 1e9;
+            return "ns";
+        } else if(seconds < 1e-3) {
+            scale = 1e6;
+            return "us";
+        } else if(seconds < 1) {
+            scale = 1e3;
+            return "ms";
+        }
+        scale = 1;
+        return "s";
+    }
 
-    void logTestCrashed() {
-        char msg[DOCTEST_SNPRINTF_BUFFER_LENGTH];
+    AllocationCheck::AllocationCheck(unsigned max, const char* assert_name, const char* expr,
+                                     const char* file, int line)
+            : m_assertName(assert_name)
+            , m_expr(expr)
+            , m_file(file)
+            , m_line(line)
+            , m_max(max)
+            , m_numBefore(getAllocationCounters().count)
+            , m_done(false) {}
 
-        DOCTEST_SNPRINTF(msg, DOCTEST_COUNTOF(msg), "  TEST CASE FAILED! (threw exception)\n\n");
+    bool AllocationCheck::once() {
+        if(!m_done) {
+            m_done = true;
+            return true;
+        }
 
-        DOCTEST_PRINTF_COLORED(msg, Color::Red);
+        const AllocationCounters& c      = getAllocationCounters();
+        unsigned                  count  = c.count - m_numBefore;
+        bool                      passed = count <= m_max;
 
-        printToDebugConsole(String(msg));
+        char buff[DOCTEST_SNPRINTF_BUFFER_LENGTH];
+        DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), "%u allocation%s", count,
+                         count == 1 ? "" : "s");
+        if(logBinaryAssert(passed, buff, false, m_expr, m_assertName, m_file, m_line))
+            checkIfShouldThrow(m_assertName);
+        return false;
+    }
+
+    // the default reporter - prints to stdout (colored if it is a terminal)
+    class ConsoleReporter : public IReporter
+    {
+        TestCaseData        m_test;
+        bool                m_hasLoggedTestStart; // the header of a test is printed lazily
+        Vector<SubcaseData> m_subcases;           // the ones currently entered
+
+        void logTestStart() {
+            if(m_hasLoggedTestStart)
+                return;
+            m_hasLoggedTestStart = true;
+
+            const char* newLine = "\n";
+
+            char loc[DOCTEST_SNPRINTF_BUFFER_LENGTH];
+            DOCTEST_SNPRINTF(loc, DOCTEST_COUNTOF(loc), "%s(%d)\n", fileForOutput(m_test.m_file),
+                             m_test.m_line);
+
+            char msg[DOCTEST_SNPRINTF_BUFFER_LENGTH];
+            DOCTEST_SNPRINTF(msg, DOCTEST_COUNTOF(msg), "%s\n", m_test.m_name);
+
+            DOCTEST_PRINTF_COLORED(getSeparator(), Color::Yellow);
+            DOCTEST_PRINTF_COLORED(loc, Color::LightGrey);
+            DOCTEST_PRINTF_COLORED(msg, Color::None);
+
+            String subcaseStuff = "";
+            String tabulation;
+            for(unsigned i = 0; i < m_subcases.size(); ++i) {
+                tabulation += "  ";
+                char subcase[DOCTEST_SNPRINTF_BUFFER_LENGTH];
+                DOCTEST_SNPRINTF(subcase, DOCTEST_COUNTOF(loc), "%s%s\n", tabulation.c_str(),
+                                 m_subcases[i].m_name);
+                DOCTEST_PRINTF_COLORED(subcase, Color::None);
+                subcaseStuff += subcase;
+            }
+
+            DOCTEST_PRINTF_COLORED(newLine, Color::None);
+
+            printToDebugConsole(String(getSeparator()) + loc + msg + subcaseStuff.c_str() +
+                                newLine);
+            flushOutput(false);
+        }
+
+    public:
+        ConsoleReporter()
+                : m_test(TestCaseData())
+                , m_hasLoggedTestStart(false) {}
+
+        virtual void testCaseStart(const TestCaseData& tc) {
+            // a test boundary - everything up to here is printed in case the test crashes
+            flushOutput(true);
+
+            m_test               = tc;
+            m_hasLoggedTestStart = false;
+            m_subcases.clear();
+
+            // if logging successful tests - force the start log
+            if(getContextState()->success)
+                logTestStart();
+        }
+
+        virtual void testCaseReenter(const TestCaseData&) { m_hasLoggedTestStart = false; }
+
+        virtual void testCaseCrashed(const TestCaseData&, const char* reason) {
+            logTestStart();
+
+            char msg[DOCTEST_SNPRINTF_BUFFER_LENGTH];
+            DOCTEST_SNPRINTF(msg, DOCTEST_COUNTOF(msg), "  TEST CASE FAILED! (%s)\n\n", reason);
+
+            DOCTEST_PRINTF_COLORED(msg, Color::Red);
+
+            printToDebugConsole(String(msg));
+            flushOutput(false);
+        }
+
+        virtual void subcaseStart(const SubcaseData& sc) {
+            m_subcases.push_back(sc);
+            m_hasLoggedTestStart = false;
+        }
+
+        virtual void subcaseEnd(const SubcaseData&) {
+            m_subcases.pop_back();
+            m_hasLoggedTestStart = false;
+        }
+
+        virtual void logAssert(const AssertData& ad) {
+            logTestStart();
+
+            char loc[DOCTEST_SNPRINTF_BUFFER_LENGTH];
+            DOCTEST_SNPRINTF(loc, DOCTEST_COUNTOF(loc), "%s(%d)", fileForOutput(ad.m_file),
+                             ad.m_line);
+
+            char msg[DOCTEST_SNPRINTF_BUFFER_LENGTH];
+            if(ad.m_passed)
+                DOCTEST_SNPRINTF(msg, DOCTEST_COUNTOF(msg), " PASSED!\n");
+            else if(ad.m_kind == AssertData::Normal)
+                DOCTEST_SNPRINTF(msg, DOCTEST_COUNTOF(msg), " FAILED! %s\n",
+                                 (ad.m_threw ? "(threw exception)" : ""));
+            else if(ad.m_kind == AssertData::ThrowsAs)
+                DOCTEST_SNPRINTF(msg, DOCTEST_COUNTOF(msg), " FAILED! %s\n",
+                                 (ad.m_threw ? "(threw something else)" :
+                                               "(didn't throw at all)"));
+            else
+                DOCTEST_SNPRINTF(msg, DOCTEST_COUNTOF(msg), " FAILED!\n");
+
+            char info1[DOCTEST_SNPRINTF_BUFFER_LENGTH];
+            char info2[DOCTEST_SNPRINTF_BUFFER_LENGTH];
+            char info3[DOCTEST_SNPRINTF_BUFFER_LENGTH];
+            info2[0] = 0;
+            info3[0] = 0;
+            if(ad.m_kind == AssertData::Normal) {
+                DOCTEST_SNPRINTF(info1, DOCTEST_COUNTOF(info1), "  %s( %s )\n", ad.m_assertName,
+                                 ad.m_expr);
+                if(!ad.m_threw) {
+                    DOCTEST_SNPRINTF(info2, DOCTEST_COUNTOF(info2), "with expansion:\n");
+                    DOCTEST_SNPRINTF(info3, DOCTEST_COUNTOF(info3), "  %s( %s )\n",
+                                     ad.m_assertName, ad.m_decomposition);
+                }
+            } else if(ad.m_kind == AssertData::ThrowsAs) {
+                DOCTEST_SNPRINTF(info1, DOCTEST_COUNTOF(info1), "  %s( %s, %s )\n\n",
+                                 ad.m_assertName, ad.m_expr, ad.m_exceptionType);
+            } else {
+                DOCTEST_SNPRINTF(info1, DOCTEST_COUNTOF(info1), "  %s( %s )\n\n", ad.m_assertName,
+                                 ad.m_expr);
+            }
+
+            DOCTEST_PRINTF_COLORED(loc, Color::LightGrey);
+            DOCTEST_PRINTF_COLORED(msg, ad.m_passed ? Color::BrightGreen : Color::Red);
+            DOCTEST_PRINTF_COLORED(info1, Color::Green);
+            DOCTEST_PRINTF_COLORED(info2, Color::None);
+            DOCTEST_PRINTF_COLORED(info3, Color::Green);
+
+            const char* newLine = ad.m_kind == AssertData::Normal ? "\n" : "";
+            DOCTEST_PRINTF_COLORED(newLine, Color::None);
+
+            printToDebugConsole(String(loc) + msg + info1 + info2 + info3 + newLine);
+            flushOutput(false);
+        }
+
+        virtual void logBenchmark(const BenchmarkData& bd) {
+            logTestStart();
+
+            char loc[DOCTEST_SNPRINTF_BUFFER_LENGTH];
+            DOCTEST_SNPRINTF(loc, DOCTEST_COUNTOF(loc), "%s(%d)", fileForOutput(bd.m_file),
+                             bd.m_line);
+
+            char msg[DOCTEST_SNPRINTF_BUFFER_LENGTH];
+            DOCTEST_SNPRINTF(msg, DOCTEST_COUNTOF(msg),
+                             " BENCHMARK( \"%s\" ) - %u samples of %u iterations\n", bd.m_name,
+                             bd.m_numSamples, bd.m_iterations);
+
+            // all in the same unit - the one suitable for the mean
+            double      scale = 1;
+            const char* unit  = getDurationUnit(bd.m_mean, scale);
+
+            char stats[DOCTEST_SNPRINTF_BUFFER_LENGTH];
+            DOCTEST_SNPRINTF(stats, DOCTEST_COUNTOF(stats),
+                             "  mean %.3f %s | median %.3f %s | stddev %.3f %s | min %.3f %s\n",
+                             bd.m_mean * scale, unit, bd.m_median * scale, unit,
+                             bd.m_stddev * scale, unit, bd.m_min * scale, unit);
+
+            // the events of an iteration with --dt-perf-counters
+            String counters;
+            char   counter[DOCTEST_SNPRINTF_BUFFER_LENGTH];
+            for(unsigned i = 0; i < perfCounter::count; ++i) {
+                if(bd.m_perfCounters[i] < 0)
+                    continue;
+                DOCTEST_SNPRINTF(counter, DOCTEST_COUNTOF(counter), "%s%.2f %s",
+                                 counters.size() ? " | " : "  ", bd.m_perfCounters[i],
+                                 perfCounterNames[i]);
+                counters += counter;
+            }
+            counters += counters.size() ? " (per iteration)\n\n" : "\n";
+
+            DOCTEST_PRINTF_COLORED(loc, Color::LightGrey);
+            DOCTEST_PRINTF_COLORED(msg, Color::None);
+            DOCTEST_PRINTF_COLORED(stats, Color::Green);
+            DOCTEST_PRINTF_COLORED(counters.c_str(), Color::Green);
+
+            printToDebugConsole(String(loc) + msg + stats + counters);
+            flushOutput(false);
+        }
+
+        virtual void runEnd(const RunStats& stats) {
+            char buff[DOCTEST_SNPRINTF_BUFFER_LENGTH];
+
+            DOCTEST_PRINTF_COLORED(getSeparator(), Color::Yellow);
+            DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
+
+            DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), "test cases: %4d",
+                             stats.m_numTestCases);
+            DOCTEST_PRINTF_COLORED(buff, Color::None);
+            DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), " | ");
+            DOCTEST_PRINTF_COLORED(buff, Color::None);
+            DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), "%4d passed",
+                             stats.m_numTestCases - stats.m_numFailedTestCases);
+            DOCTEST_PRINTF_COLORED(buff, Color::Green);
+            DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), " | ");
+            DOCTEST_PRINTF_COLORED(buff, Color::None);
+            DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), "%4d failed\n",
+                             stats.m_numFailedTestCases);
+            DOCTEST_PRINTF_COLORED(buff, Color::Red);
+
+            DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
+
+            DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), "assertions: %4d",
+                             stats.m_numAssertions);
+            DOCTEST_PRINTF_COLORED(buff, Color::None);
+            DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), " | ");
+            DOCTEST_PRINTF_COLORED(buff, Color::None);
+            DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), "%4d passed",
+                             stats.m_numAssertions - stats.m_numFailedAssertions);
+            DOCTEST_PRINTF_COLORED(buff, Color::Green);
+            DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), " | ");
+            DOCTEST_PRINTF_COLORED(buff, Color::None);
+            DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), "%4d failed\n",
+                             stats.m_numFailedAssertions);
+            DOCTEST_PRINTF_COLORED(buff, Color::Red);
+            flushOutput(false);
+        }
+    };
+
+    // prints the durations (wall clock and CPU time), the allocations and/or the perf counters of
+    // the test cases as they end - along with the executions for the separate paths of subcases -
+    // and a table of the slowest test cases and the totals of the perf counters at the end. Only
+    // the slowest ones so far are kept in memory - for --dt-durations, --dt-allocations and
+    // --dt-perf-counters
+    class TestStatsReporter : public IReporter
+    {
+        struct SlowTest
+        {
+            TestCaseData  test;
+            TestCaseStats stats;
+        };
+
+        bool                m_durations;
+        bool                m_allocations;
+        unsigned            m_perfCounters; // the events counted (bits of perfCounter::Enum)
+        double              m_perfTotals[perfCounter::count]; // negative if never counted
+        unsigned            m_numSlowest;
+        Vector<SlowTest>    m_slowest;    // longest first - at most m_numSlowest of them
+        Vector<SubcaseData> m_subcases;   // the ones currently entered
+        String              m_path;       // of the subcases entered in the current execution
+        String              m_iterations; // the lines for the executions of the current test
+
+        String formatStats(const TestCaseStats& stats, const char* indent, const char* what) const {
+            String res;
+            char   buff[DOCTEST_SNPRINTF_BUFFER_LENGTH];
+            if(m_durations) {
+                DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), "%10.6f s | cpu %10.6f s | ",
+                                 stats.m_duration, stats.m_cpuDuration);
+                res += buff;
+            }
+            if(m_allocations) {
+                DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff),
+                                 "%8u allocs | %10lu bytes | peak %10lu | ", stats.m_numAllocations,
+                                 stats.m_allocatedBytes, stats.m_peakAllocatedBytes);
+                res += buff;
+            }
+            for(unsigned i = 0; i < perfCounter::count; ++i) {
+                if((m_perfCounters & (1u << i)) == 0)
+                    continue;
+                if(stats.m_perfCounters[i] < 0)
+                    DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), "%14s %s | ", "-",
+                                     perfCounterNames[i]);
+                else
+                    DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), "%14.0f %s | ",
+                                     stats.m_perfCounters[i], perfCounterNames[i]);
+                res += buff;
+            }
+            res += indent;
+            res += what;
+            return res + "\n";
+        }
+
+    public:
+        // the table of the slowest test cases is only with durations
+        TestStatsReporter(bool durations, bool allocations, unsigned perfCounters,
+                          unsigned numSlowest)
+                : m_durations(durations)
+                , m_allocations(allocations)
+                , m_perfCounters(perfCounters)
+                , m_numSlowest(durations ? numSlowest : 0) {
+            for(unsigned i = 0; i < perfCounter::count; ++i)
+                m_perfTotals[i] = -1;
+        }
+
+        virtual void testCaseStart(const TestCaseData&) {
+            m_subcases.clear();
+            m_path       = "";
+            m_iterations = "";
+        }
+
+        virtual void testCaseReenter(const TestCaseData&) { m_path = ""; }
+
+        virtual void subcaseStart(const SubcaseData& sc) {
+            m_subcases.push_back(sc);
+            m_path = "";
+            for(unsigned i = 0; i < m_subcases.size(); ++i)
+                m_path += String(i > 0 ? " / " : "") + m_subcases[i].m_name;
+        }
+
+        virtual void subcaseEnd(const SubcaseData&) { m_subcases.pop_back(); }
+
+        virtual void testCaseIterationEnd(const TestCaseData&, const TestCaseStats& stats) {
+            m_iterations += formatStats(stats, "  ", m_path.size() ? m_path.c_str() : "-");
+        }
+
+        virtual void testCaseEnd(const TestCaseData& tc, const TestCaseStats& stats) {
+            DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
+            writeOutput(formatStats(stats, "", tc.m_name).c_str());
+
+            // the lines for the executions are printed after the line for the whole test case
+            const char* line = m_iterations.c_str();
+            while(*line) {
+                const char* end = strchr(line, '\n') + 1;
+                DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
+                bufferOutput(line, static_cast<unsigned>(end - line));
+                line = end;
+            }
+            flushOutput(false);
+
+            for(unsigned i = 0; i < perfCounter::count; ++i)
+                if(stats.m_perfCounters[i] >= 0)
+                    m_perfTotals[i] = my_max(m_perfTotals[i], 0.0) + stats.m_perfCounters[i];
+
+            // insertion into the sorted list of the slowest test cases
+            if(m_numSlowest == 0 || (m_slowest.size() == m_numSlowest &&
+                                     m_slowest[m_numSlowest - 1].stats.m_duration >=
+                                             stats.m_duration))
+                return;
+            SlowTest slow = {tc, stats};
+            if(m_slowest.size() == m_numSlowest)
+                m_slowest.pop_back();
+            m_slowest.push_back(slow);
+            for(unsigned i = m_slowest.size() - 1;
+                i > 0 && m_slowest[i - 1].stats.m_duration < m_slowest[i].stats.m_duration; --i) {
+                SlowTest temp    = m_slowest[i - 1];
+                m_slowest[i - 1] = m_slowest[i];
+                m_slowest[i]     = temp;
+            }
+        }
+
+        virtual void runEnd(const RunStats&) {
+            char buff[DOCTEST_SNPRINTF_BUFFER_LENGTH];
+            if(m_slowest.size() > 0) {
+                DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), "the %u slowest test cases:\n",
+                                 m_slowest.size());
+                DOCTEST_PRINTF_COLORED(getSeparator(), Color::Yellow);
+                DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
+                writeOutput(buff);
+                for(unsigned i = 0; i < m_slowest.size(); ++i) {
+                    const SlowTest& slow = m_slowest[i];
+                    DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), "%s - %s(%u)", slow.test.m_name,
+                                     fileForOutput(slow.test.m_file), slow.test.m_line);
+                    DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
+                    writeOutput(formatStats(slow.stats, "", buff).c_str());
+                }
+            }
+
+            if(m_perfCounters) {
+                DOCTEST_PRINTF_COLORED(getSeparator(), Color::Yellow);
+                DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
+                writeOutput("the perf counters of all test cases:\n");
+            }
+            for(unsigned i = 0; i < perfCounter::count; ++i) {
+                if((m_perfCounters & (1u << i)) == 0)
+                    continue;
+                if(m_perfTotals[i] < 0)
+                    DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), "%14s %s", "-",
+                                     perfCounterNames[i]);
+                else
+                    DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), "%14.0f %s", m_perfTotals[i],
+                                     perfCounterNames[i]);
+                String line = buff;
+
+                // the ratios of the related events
+                unsigned    base = perfCounter::count;
+                const char* what = "";
+                double      unit = 1;
+                if(i == perfCounter::instructions) {
+                    base = perfCounter::cycles;
+                    what = " per cycle";
+                } else if(i == perfCounter::cacheMisses) {
+                    base = perfCounter::cacheReferences;
+                    what = "% of the references";
+                    unit = 100;
+                } else if(i == perfCounter::branchMisses) {
+                    base = perfCounter::branches;
+                    what = "% of the branches";
+                    unit = 100;
+                }
+                if(base < perfCounter::count && m_perfTotals[base] > 0 && m_perfTotals[i] >= 0) {
+                    DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), " | %.2f%s",
+                                     unit * m_perfTotals[i] / m_perfTotals[base], what);
+                    line += buff;
+                }
+                DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
+                writeOutput((line + "\n").c_str());
+            }
+            flushOutput(false);
+        }
+    };
+
+    // reads a whole file - returns false if it can't be opened
+    bool readFile(const String& path, String& contents) {
+        FILE* f = fopen(path.c_str(), "rb");
+        if(!f)
+            return false;
+        char   buffer[DOCTEST_SNPRINTF_BUFFER_LENGTH];
+        size_t numRead;
+        while((numRead = fread(buffer, 1, DOCTEST_COUNTOF(buffer) - 1, f)) > 0) {
+            buffer[numRead] = '\0';
+            contents += buffer;
+        }
+        fclose(f);
+        return true;
+    }
+
+    // the results of a benchmark recorded by a previous run (--dt-benchmark-out) - identified by
+    // the file of the benchmark, the name of its test case and its own name (but not by its line)
+    struct RecordedBenchmark
+    {
+        const char* file;
+        const char* test;
+        const char* name;
+        double      mean;
+        double      stddev;
+        unsigned    numSamples;
+    };
+
+    // for sorting and searching recorded benchmarks by file/test/name
+    int recordedBenchmarkComparator(const void* a, const void* b) {
+        const RecordedBenchmark* lhs = static_cast<const RecordedBenchmark*>(a);
+        const RecordedBenchmark* rhs = static_cast<const RecordedBenchmark*>(b);
+
+        int res = strcmp(lhs->file, rhs->file);
+        if(res == 0)
+            res = strcmp(lhs->test, rhs->test);
+        if(res == 0)
+            res = strcmp(lhs->name, rhs->name);
+        return res;
+    }
+
+    void sortRecordedBenchmarks(Vector<RecordedBenchmark>& benchmarks) {
+        if(benchmarks.size() > 0)
+            qsort(benchmarks.data(), benchmarks.size(), sizeof(RecordedBenchmark),
+                  recordedBenchmarkComparator);
+    }
+
+    const RecordedBenchmark* findRecordedBenchmark(const Vector<RecordedBenchmark>& benchmarks,
+                                                   unsigned count, const RecordedBenchmark& key) {
+        if(count == 0)
+            return 0;
+        return static_cast<const RecordedBenchmark*>(bsearch(&key, benchmarks.data(), count,
+                                                             sizeof(RecordedBenchmark),
+                                                             recordedBenchmarkComparator));
+    }
+
+    // reads the results of benchmarks recorded by a previous run - one line for each benchmark:
+    // "<mean> <stddev> <samples>\t<file>\t<test case>\t<benchmark>" with the durations of an
+    // iteration in seconds. The strings point inside 'contents' so it should outlive the result.
+    // Returns false if the file can't be opened
+    bool readBenchmarksFile(const String& path, String& contents,
+                            Vector<RecordedBenchmark>& benchmarks) {
+        if(!readFile(path, contents))
+            return false;
+
+        char* curr = contents.c_str();
+        while(*curr) {
+            char* end = strchr(curr, '\n');
+            if(end)
+                *end = '\0';
+            // strip a '\r' left from files with windows line endings
+            size_t len = strlen(curr);
+            if(len > 0 && curr[len - 1] == '\r')
+                curr[len - 1] = '\0';
+
+            char*             afterMean   = 0;
+            char*             afterStddev = 0;
+            char*             afterCount  = 0;
+            RecordedBenchmark entry;
+            entry.mean       = strtod(curr, &afterMean);
+            entry.stddev     = strtod(afterMean, &afterStddev);
+            entry.numSamples = static_cast<unsigned>(strtoul(afterStddev, &afterCount, 10));
+
+            // the strings are separated by tabs
+            char* test = *afterCount == '\t' ? strchr(afterCount + 1, '\t') : 0;
+            char* name = test ? strchr(test + 1, '\t') : 0;
+
+            // ignore malformed lines
+            if(name && afterMean != curr && afterStddev != afterMean && afterCount != afterStddev &&
+               entry.mean >= 0 && entry.stddev >= 0) {
+                *test = *name = '\0';
+                entry.file    = afterCount + 1;
+                entry.test    = test + 1;
+                entry.name    = name + 1;
+                benchmarks.push_back(entry);
+            }
+
+            if(!end)
+                break;
+            curr = end + 1;
+        }
+        sortRecordedBenchmarks(benchmarks);
+        return true;
+    }
+
+    // writes a string in a file of recorded benchmarks - tabs and new lines would break its format
+    void writeBenchmarkField(FILE* f, const char* str) {
+        fputc('\t', f);
+        for(; *str; ++str)
+            fputc(*str == '\t' || *str == '\n' || *str == '\r' ? ' ' : *str, f);
+    }
+
+    // records the results of the benchmarks at the end of the run - keeping the recorded ones of
+    // the benchmarks which weren't executed - for --dt-benchmark-out
+    class BenchmarkOutReporter : public IReporter
+    {
+        String                    m_path;
+        const char*               m_test; // the name of the current test case
+        Vector<RecordedBenchmark> m_results;
+
+    public:
+        BenchmarkOutReporter(const String& path)
+                : m_path(path)
+                , m_test("") {}
+
+        virtual void testCaseStart(const TestCaseData& tc) { m_test = tc.m_name; }
+
+        virtual void logBenchmark(const BenchmarkData& bd) {
+            RecordedBenchmark entry = {bd.m_file, m_test, bd.m_name, bd.m_mean, bd.m_stddev,
+                                       bd.m_numSamples};
+            m_results.push_back(entry);
+        }
+
+        virtual void runEnd(const RunStats&) {
+            String                    contents;
+            Vector<RecordedBenchmark> recorded; // none if the file doesn't exist yet
+            readBenchmarksFile(m_path, contents, recorded);
+
+            // a benchmark executed more than once (for the subcases of its test) is recorded once
+            Vector<RecordedBenchmark> results;
+            sortRecordedBenchmarks(m_results);
+            for(unsigned i = 0; i < m_results.size(); ++i)
+                if(i == 0 || recordedBenchmarkComparator(&m_results[i - 1], &m_results[i]) != 0)
+                    results.push_back(m_results[i]);
+
+            unsigned numExecuted = results.size();
+            for(unsigned i = 0; i < recorded.size(); ++i)
+                if(!findRecordedBenchmark(results, numExecuted, recorded[i]))
+                    results.push_back(recorded[i]);
+            sortRecordedBenchmarks(results);
+
+            FILE* f = fopen(m_path.c_str(), "wb");
+            if(!f)
+                return;
+            for(unsigned i = 0; i < results.size(); ++i) {
+                fprintf(f, "%.9g %.9g %u", results[i].mean, results[i].stddev,
+                        results[i].numSamples);
+                writeBenchmarkField(f, results[i].file);
+                writeBenchmarkField(f, results[i].test);
+                writeBenchmarkField(f, results[i].name);
+                fputc('\n', f);
+            }
+            fclose(f);
+        }
+    };
+
+    // for reporters which write to the file given with --dt-out - or to stdout (through the output
+    // buffer so it stays in order with the rest of the output) if there is no such file
+    void writeReporterOutput(FILE* file, const char* text, unsigned len) {
+        if(file)
+            fwrite(text, 1, len, file);
+        else
+            bufferOutput(text, len);
+    }
+
+    // writes the results in the JUnit XML format - each <testcase> is written as soon as its test
+    // ends so only the failures of the current test are kept in memory and not a document
+    class JUnitReporter : public IReporter
+    {
+        FILE*               m_file;          // null for stdout (through the output buffer)
+        long                m_attributesPos; // where the totals go when the run ends (or -1)
+        Vector<char>        m_failures;      // the XML for the failures of the current test
+        Vector<SubcaseData> m_subcases;      // the ones currently entered
+        bool                m_crashed;
+        unsigned            m_numTests;
+        unsigned            m_numFailures;
+        unsigned            m_numErrors;
+        double              m_time;
+
+        void write(const char* text, unsigned len) { writeReporterOutput(m_file, text, len); }
+
+        void write(const char* text) { write(text, my_strlen(text)); }
+
+        static void append(Vector<char>& out, const char* text, unsigned len) {
+            unsigned size = out.size();
+            out.resize(size + len);
+            memcpy(out.data() + size, text, len);
+        }
+
+        static void append(Vector<char>& out, const char* text) {
+            append(out, text, my_strlen(text));
+        }
+
+        // appends text with the characters special for XML replaced by entities - and the control
+        // characters which are not allowed in XML 1.0 replaced by '?'
+        static void appendEscaped(Vector<char>& out, const char* text) {
+            const char* start = text;
+            for(; *text; ++text) {
+                const char* entity = 0;
+                switch(*text) {
+                    case '&': entity = "&amp;"; break;
+                    case '<': entity = "&lt;"; break;
+                    case '>': entity = "&gt;"; break;
+                    case '"': entity = "&quot;"; break;
+                    case '\'': entity = "&apos;"; break;
+                    case '\t':
+                    case '\n':
+                    case '\r': break;
+                    default:
+                        if(static_cast<unsigned char>(*text) < 0x20)
+                            entity = "?";
+                }
+                if(entity) {
+                    append(out, start, static_cast<unsigned>(text - start));
+                    append(out, entity);
+                    start = text + 1;
+                }
+            }
+            append(out, start, static_cast<unsigned>(text - start));
+        }
+
+    public:
+        JUnitReporter(FILE* file)
+                : m_file(file)
+                , m_attributesPos(-1)
+                , m_crashed(false)
+                , m_numTests(0)
+                , m_numFailures(0)
+                , m_numErrors(0)
+                , m_time(0) {
+            write("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<testsuites>\n  <testsuite "
+                  "name=\"doctest\"");
+            // the totals are known only at the end - space for them is reserved in the tag
+            // (whitespace in it is valid XML) when they can be written there later
+            if(m_file)
+                m_attributesPos = ftell(m_file);
+            if(m_attributesPos >= 0)
+                write("                                                                      "
+                      "                          ");
+            write(">\n");
+        }
+
+        virtual void testCaseStart(const TestCaseData&) {
+            m_failures.clear();
+            m_subcases.clear();
+            m_crashed = false;
+        }
+
+        virtual void testCaseEnd(const TestCaseData& tc, const TestCaseStats& stats) {
+            Vector<char> tag;
+            append(tag, "    <testcase classname=\"");
+            appendEscaped(tag, tc.m_suite[0] ? tc.m_suite : fileForOutput(tc.m_file));
+            append(tag, "\" name=\"");
+            appendEscaped(tag, tc.m_name);
+            char buff[DOCTEST_SNPRINTF_BUFFER_LENGTH];
+            DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), "\" time=\"%.6f\"", stats.m_duration);
+            append(tag, buff);
+            write(tag.data(), tag.size());
+            if(m_failures.size() > 0) {
+                write(">\n");
+                write(m_failures.data(), m_failures.size());
+                write("    </testcase>\n");
+            } else {
+                write("/>\n");
+            }
+
+            m_numTests++;
+            if(m_crashed)
+                m_numErrors++;
+            else if(stats.m_failed)
+                m_numFailures++;
+            m_time += stats.m_duration;
+            if(!m_file)
+                flushOutput(false);
+        }
+
+        virtual void testCaseCrashed(const TestCaseData&, const char* reason) {
+            m_crashed = true;
+            append(m_failures, "      <error message=\"");
+            appendEscaped(m_failures, reason);
+            append(m_failures, "\"/>\n");
+        }
+
+        virtual void subcaseStart(const SubcaseData& sc) { m_subcases.push_back(sc); }
+
+        virtual void subcaseEnd(const SubcaseData&) { m_subcases.pop_back(); }
+
+        virtual void logAssert(const AssertData& ad) {
+            // passed asserts have no place in the format and failed warnings don't fail tests
+            if(ad.m_passed || strncmp(ad.m_assertName, "WARN", 4) == 0)
+                return;
+
+            String expr = String(ad.m_assertName) + "( " + ad.m_expr;
+            if(ad.m_kind == AssertData::ThrowsAs)
+                expr += String(", ") + ad.m_exceptionType;
+            expr += " )";
+
+            append(m_failures, "      <failure message=\"");
+            appendEscaped(m_failures, expr.c_str());
+            append(m_failures, "\" type=\"");
+            appendEscaped(m_failures, ad.m_assertName);
+            append(m_failures, "\">");
+
+            // the same details as in the console output
+            char loc[DOCTEST_SNPRINTF_BUFFER_LENGTH];
+            DOCTEST_SNPRINTF(loc, DOCTEST_COUNTOF(loc), "%s(%d)\n", fileForOutput(ad.m_file),
+                             ad.m_line);
+            appendEscaped(m_failures, loc);
+            String tabulation;
+            for(unsigned i = 0; i < m_subcases.size(); ++i) {
+                tabulation += "  ";
+                appendEscaped(m_failures, (tabulation + m_subcases[i].m_name + "\n").c_str());
+            }
+            if(ad.m_kind == AssertData::Normal && !ad.m_threw)
+                appendEscaped(m_failures, (String("with expansion:\n  ") + ad.m_assertName +
+                                           "( " + ad.m_decomposition + " )\n")
+                                                  .c_str());
+            else if(ad.m_kind == AssertData::ThrowsAs && ad.m_threw)
+                append(m_failures, "threw something else\n");
+            else if(ad.m_kind == AssertData::Throws || ad.m_kind == AssertData::ThrowsAs)
+                append(m_failures, "didn't throw at all\n");
+            else
+                append(m_failures, "threw exception\n");
+            append(m_failures, "</failure>\n");
+        }
+
+        virtual void runEnd(const RunStats&) {
+            write("  </testsuite>\n</testsuites>\n");
+            if(m_attributesPos >= 0 && fseek(m_file, m_attributesPos, SEEK_SET) == 0) {
+                fprintf(m_file, " tests=\"%u\" failures=\"%u\" errors=\"%u\" time=\"%.6f\"",
+                        m_numTests, m_numFailures, m_numErrors, m_time);
+                fseek(m_file, 0, SEEK_END);
+            }
+            if(!m_file)
+                flushOutput(false);
+        }
+    };
+
+    // the binary log written by the binlog reporter and read back with --dt-decode-log. After a
+    // header come records which all have the same fixed layout followed by a payload - so they are
+    // cheap to append and can be read (or memory-mapped) without parsing any text. Strings such as
+    // file names and expressions are written once in binlogString records (which give them an id)
+    // and are then referred to by id - only the decompositions of asserts are in the payloads.
+    // The fields used by each type of record:
+    //
+    //   type          | strings                          | ints
+    //   --------------+----------------------------------+-------------------------------------
+    //   binlogString  | -                                | id, length (the payload is the string)
+    //   testCase*     | file, name, suite, crash reason  | line, failed, asserts, failed asserts
+    //   subcase*      | name, file                       | line
+    //   logAssert     | assert name, file, expr, ex type | line, kind, passed/threw/threwAs bits
+    //   logBenchmark  | name, file                       | line, samples, iterations
+    //   runEnd        | -                                | tests, failed tests, asserts, failed
+    //                 |                                  | asserts
+    //
+    // the wall clock and CPU durations of test cases are in 'numbers' and their allocations (count,
+    // bytes and peak) followed by the perf counters are the payload (doubles) of the records with
+    // their totals. The mean, median, stddev and min of benchmarks followed by the perf counters
+    // are the payload (doubles) and the string with id 0 is the empty string
+    struct BinlogHeader
+    {
+        char     magic[8];
+        unsigned version;
+        unsigned byteOrder; // binlogByteOrder as written by the machine which wrote the log
+    };
+
+    struct BinlogRecord
+    {
+        unsigned type;       // reporterEvent::Enum or binlogString
+        unsigned size;       // of the record together with its payload - a multiple of 8
+        unsigned strings[4]; // ids of strings
+        int      ints[4];
+        double   numbers[2];
+    };
+
+    const char     binlogMagic[8]  = {'d', 't', 'b', 'i', 'n', 'l', 'o', 'g'};
+    const unsigned binlogVersion   = 1;
+    const unsigned binlogByteOrder = 0x01020304;
+    const unsigned binlogString    = 0xff;
+
+    // a string in the string table of a binary log - looked up by its address first and then by
+    // its contents (the same literal has a different address in each translation unit)
+    struct InternedString
+    {
+        const char* str;
+        unsigned    id;
+
+        bool operator==(const InternedString& other) const { return str == other.str; }
+    };
+
+    struct InternedContents
+    {
+        const char* str;
+        unsigned    id;
+
+        bool operator==(const InternedContents& other) const {
+            return strcmp(str, other.str) == 0;
+        }
+    };
+
+    unsigned Hash(const InternedString& in) {
+        return static_cast<unsigned>(reinterpret_cast<size_t>(in.str));
+    }
+
+    unsigned Hash(const InternedContents& in) {
+        return hashStr(reinterpret_cast<unsigned const char*>(in.str));
+    }
+
+    // writes the events of the run in the binary log format - without formatting any text
+    class BinlogReporter : public IReporter
+    {
+        FILE*                       m_file; // null for stdout (through the output buffer)
+        HashTable<InternedString>   m_byAddress;
+        HashTable<InternedContents> m_byContents;
+        unsigned                    m_numStrings;
+        Vector<char>                m_record;
+
+        static BinlogRecord makeRecord(unsigned type) {
+            BinlogRecord r;
+            memset(&r, 0, sizeof(r));
+            r.type = type;
+            return r;
+        }
+
+        // the record is assembled with its payload so it is written with a single call
+        void writeRecord(BinlogRecord& r, const char* payload = "", unsigned len = 0) {
+            r.size = (static_cast<unsigned>(sizeof(r)) + len + 7) & ~7u;
+            m_record.resize(r.size);
+            memcpy(m_record.data(), &r, sizeof(r));
+            memcpy(m_record.data() + sizeof(r), payload, len);
+            memset(m_record.data() + sizeof(r) + len, 0, r.size - sizeof(r) - len);
+            writeReporterOutput(m_file, m_record.data(), r.size);
+        }
+
+        // returns the id of a string - writing it in the string table if it is a new one
+        unsigned intern(const char* str) {
+            if(!str || !*str)
+                return 0;
+            InternedString        key   = {str, 0};
+            const InternedString* found = m_byAddress.find(key);
+            if(found)
+                return found->id;
+
+            InternedContents        contents = {str, 0};
+            const InternedContents* same     = m_byContents.find(contents);
+            if(same) {
+                key.id = same->id;
+            } else {
+                key.id = contents.id = ++m_numStrings;
+                m_byContents.insert(contents);
+
+                unsigned     len = my_strlen(str);
+                BinlogRecord r   = makeRecord(binlogString);
+                r.ints[0]        = static_cast<int>(key.id);
+                r.ints[1]        = static_cast<int>(len);
+                writeRecord(r, str, len + 1);
+            }
+            m_byAddress.insert(key);
+            return key.id;
+        }
+
+        BinlogRecord makeTestCaseRecord(unsigned type, const TestCaseData& tc) {
+            BinlogRecord r = makeRecord(type);
+            r.strings[0]   = intern(tc.m_file);
+            r.strings[1]   = intern(tc.m_name);
+            r.strings[2]   = intern(tc.m_suite);
+            r.ints[0]      = static_cast<int>(tc.m_line);
+            return r;
+        }
+
+        void writeTestCaseStatsRecord(unsigned type, const TestCaseData& tc,
+                                      const TestCaseStats& stats) {
+            BinlogRecord r = makeTestCaseRecord(type, tc);
+            r.ints[1]      = stats.m_failed ? 1 : 0;
+            r.ints[2]      = stats.m_numAssertions;
+            r.ints[3]      = stats.m_numFailedAssertions;
+            r.numbers[0]   = stats.m_duration;
+            r.numbers[1]   = stats.m_cpuDuration;
+
+            double numbers[3 + perfCounter::count] = {
+                    static_cast<double>(stats.m_numAllocations),
+                    static_cast<double>(stats.m_allocatedBytes),
+                    static_cast<double>(stats.m_peakAllocatedBytes)};
+            memcpy(numbers + 3, stats.m_perfCounters, sizeof(stats.m_perfCounters));
+            writeRecord(r, reinterpret_cast<const char*>(numbers),
+                        static_cast<unsigned>(sizeof(numbers)));
+        }
+
+        BinlogRecord makeSubcaseRecord(unsigned type, const SubcaseData& sc) {
+            BinlogRecord r = makeRecord(type);
+            r.strings[0]   = intern(sc.m_name);
+            r.strings[1]   = intern(sc.m_file);
+            r.ints[0]      = sc.m_line;
+            return r;
+        }
+
+    public:
+        BinlogReporter(FILE* file)
+                : m_file(file)
+                , m_byAddress(1024)
+                , m_byContents(1024)
+                , m_numStrings(0) {
+            BinlogHeader header;
+            memcpy(header.magic, binlogMagic, sizeof(header.magic));
+            header.version   = binlogVersion;
+            header.byteOrder = binlogByteOrder;
+            writeReporterOutput(m_file, reinterpret_cast<const char*>(&header), sizeof(header));
+        }
+
+        virtual void testCaseStart(const TestCaseData& tc) {
+            BinlogRecord r = makeTestCaseRecord(reporterEvent::testCaseStart, tc);
+            writeRecord(r);
+        }
+
+        virtual void testCaseReenter(const TestCaseData& tc) {
+            BinlogRecord r = makeTestCaseRecord(reporterEvent::testCaseReenter, tc);
+            writeRecord(r);
+        }
+
+        virtual void testCaseIterationEnd(const TestCaseData& tc, const TestCaseStats& stats) {
+            writeTestCaseStatsRecord(reporterEvent::testCaseIterationEnd, tc, stats);
+        }
+
+        virtual void testCaseEnd(const TestCaseData& tc, const TestCaseStats& stats) {
+            writeTestCaseStatsRecord(reporterEvent::testCaseEnd, tc, stats);
+            if(!m_file)
+                flushOutput(false);
+        }
+
+        virtual void testCaseCrashed(const TestCaseData& tc, const char* reason) {
+            BinlogRecord r = makeTestCaseRecord(reporterEvent::testCaseCrashed, tc);
+            r.strings[3]   = intern(reason);
+            writeRecord(r);
+        }
+
+        virtual void subcaseStart(const SubcaseData& sc) {
+            BinlogRecord r = makeSubcaseRecord(reporterEvent::subcaseStart, sc);
+            writeRecord(r);
+        }
+
+        virtual void subcaseEnd(const SubcaseData& sc) {
+            BinlogRecord r = makeSubcaseRecord(reporterEvent::subcaseEnd, sc);
+            writeRecord(r);
+        }
+
+        virtual void logAssert(const AssertData& ad) {
+            BinlogRecord r = makeRecord(reporterEvent::logAssert);
+            r.strings[0]   = intern(ad.m_assertName);
+            r.strings[1]   = intern(ad.m_file);
+            r.strings[2]   = intern(ad.m_expr);
+            r.strings[3]   = intern(ad.m_exceptionType);
+            r.ints[0]      = ad.m_line;
+            r.ints[1]      = ad.m_kind;
+            r.ints[2]      = (ad.m_passed ? 1 : 0) | (ad.m_threw ? 2 : 0) | (ad.m_threwAs ? 4 : 0);
+            writeRecord(r, ad.m_decomposition, my_strlen(ad.m_decomposition) + 1);
+        }
+
+        virtual void logBenchmark(const BenchmarkData& bd) {
+            BinlogRecord r = makeRecord(reporterEvent::logBenchmark);
+            r.strings[0]   = intern(bd.m_name);
+            r.strings[1]   = intern(bd.m_file);
+            r.ints[0]      = bd.m_line;
+            r.ints[1]      = static_cast<int>(bd.m_numSamples);
+            r.ints[2]      = static_cast<int>(bd.m_iterations);
+            double stats[4 + perfCounter::count] = {bd.m_mean, bd.m_median, bd.m_stddev, bd.m_min};
+            memcpy(stats + 4, bd.m_perfCounters, sizeof(bd.m_perfCounters));
+            writeRecord(r, reinterpret_cast<const char*>(stats),
+                        static_cast<unsigned>(sizeof(stats)));
+        }
+
+        virtual void runEnd(const RunStats& stats) {
+            BinlogRecord r = makeRecord(reporterEvent::runEnd);
+            r.ints[0]      = static_cast<int>(stats.m_numTestCases);
+            r.ints[1]      = static_cast<int>(stats.m_numFailedTestCases);
+            r.ints[2]      = stats.m_numAssertions;
+            r.ints[3]      = stats.m_numFailedAssertions;
+            writeRecord(r);
+            if(!m_file)
+                flushOutput(false);
+        }
+    };
+
+    // reports the events from a binary log to the reporters of the run (instead of running tests)
+    // - only for the test cases passing the filters and passed asserts are skipped unless -s is
+    // used. The log is read one record at a time. Returns the number of failed test cases - or 1
+    // more if the log is corrupt or truncated (it ends without the record of the end of the run)
+    unsigned decodeLog(ContextState* p) {
+        FILE*        f = fopen(p->decode_log.c_str(), "rb");
+        BinlogHeader header;
+        if(!f || fread(&header, sizeof(header), 1, f) != 1 ||
+           memcmp(header.magic, binlogMagic, sizeof(header.magic)) != 0 ||
+           header.version != binlogVersion || header.byteOrder != binlogByteOrder) {
+            if(f)
+                fclose(f);
+            DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
+            writeOutput((String("cannot decode \"") + p->decode_log + "\"\n").c_str());
+            return 1;
+        }
+
+        // the filters aren't cached by address - the strings are read from the log
+        Filter fileFilter(p->filters[0], p->case_sensitive, true);
+        Filter fileExcludeFilter(p->filters[1], p->case_sensitive, false);
+        Filter suiteFilter(p->filters[2], p->case_sensitive, true);
+        Filter suiteExcludeFilter(p->filters[3], p->case_sensitive, false);
+        Filter nameFilter(p->filters[4], p->case_sensitive, true);
+        Filter nameExcludeFilter(p->filters[5], p->case_sensitive, false);
+
+        Vector<char*> strings(1, static_cast<char*>(0)); // the string table - indexed by id
+        Vector<char>  payload;
+        BinlogRecord  r;
+
+        bool     skipping   = false; // if the current test case doesn't pass the filters
+        bool     hasSkipped = false;
+        bool     hasRunEnd  = false;
+        bool     isCorrupt  = false;
+        RunStats logged     = RunStats(); // as written in the log
+        RunStats decoded    = RunStats(); // of the decoded test cases
+
+        while(fread(&r, sizeof(r), 1, f) == 1) {
+            // the size of the payload isn't trusted before it has been read
+            unsigned len = r.size - static_cast<unsigned>(sizeof(r));
+            if(r.size < sizeof(r) || (r.size & 7u) != 0) {
+                isCorrupt = true;
+                break;
+            }
+            payload.resize(len + 1);
+            if(len && fread(payload.data(), 1, len, f) != len) {
+                isCorrupt = true;
+                break;
+            }
+            payload[len] = 0;
+
+            // the ids are given in order (starting from 1) so the table grows by one each time
+            if(r.type == binlogString) {
+                if(static_cast<unsigned>(r.ints[0]) != strings.size()) {
+                    isCorrupt = true;
+                    break;
+                }
+                strings.push_back(new char[len + 1]);
+                memcpy(strings[strings.size() - 1], payload.data(), len + 1);
+                continue;
+            }
+
+            // the ids of strings from the record - the empty string for unknown ones
+            const char* s[4];
+            for(unsigned i = 0; i < 4; ++i)
+                s[i] = r.strings[i] < strings.size() && strings[r.strings[i]] ?
+                               strings[r.strings[i]] :
+                               "";
+
+            // records of a type from a newer version of the format are skipped
+            if(r.type > reporterEvent::runEnd)
+                continue;
+
+            ReporterEvent e = makeEvent(static_cast<reporterEvent::Enum>(r.type));
+            switch(r.type) {
+                case reporterEvent::testCaseStart:
+                    skipping = !fileFilter.matches(s[0]) || fileExcludeFilter.matches(s[0]) ||
+                               !suiteFilter.matches(s[2]) || suiteExcludeFilter.matches(s[2]) ||
+                               !nameFilter.matches(s[1]) || nameExcludeFilter.matches(s[1]);
+                    hasSkipped = hasSkipped || skipping;
+                // fallthrough
+                case reporterEvent::testCaseReenter:
+                case reporterEvent::testCaseIterationEnd:
+                case reporterEvent::testCaseEnd:
+                case reporterEvent::testCaseCrashed:
+                    e.testCase.m_file                     = s[0];
+                    e.testCase.m_name                     = s[1];
+                    e.testCase.m_suite                    = s[2];
+                    e.testCase.m_line                     = static_cast<unsigned>(r.ints[0]);
+                    e.reason                              = s[3];
+                    e.testCaseStats.m_failed              = r.ints[1] != 0;
+                    e.testCaseStats.m_numAssertions       = r.ints[2];
+                    e.testCaseStats.m_numFailedAssertions = r.ints[3];
+                    e.testCaseStats.m_duration            = r.numbers[0];
+                    e.testCaseStats.m_cpuDuration         = r.numbers[1];
+                    if(len >= 3 * sizeof(double)) {
+                        double numbers[3 + perfCounter::count];
+                        for(unsigned i = 3; i < DOCTEST_COUNTOF(numbers); ++i)
+                            numbers[i] = -1;
+                        memcpy(numbers, payload.data(), my_min<size_t>(len, sizeof(numbers)));
+                        e.testCaseStats.m_numAllocations = static_cast<unsigned>(numbers[0]);
+                        e.testCaseStats.m_allocatedBytes = static_cast<unsigned long>(numbers[1]);
+                        e.testCaseStats.m_peakAllocatedBytes =
+                                static_cast<unsigned long>(numbers[2]);
+                        memcpy(e.testCaseStats.m_perfCounters, numbers + 3,
+                               sizeof(e.testCaseStats.m_perfCounters));
+                    }
+                    break;
+                case reporterEvent::subcaseStart:
+                case reporterEvent::subcaseEnd:
+                    e.subcase.m_name = s[0];
+                    e.subcase.m_file = s[1];
+                    e.subcase.m_line = r.ints[0];
+                    break;
+                case reporterEvent::logAssert:
+                    e.assertData.m_assertName    = s[0];
+                    e.assertData.m_file          = s[1];
+                    e.assertData.m_expr          = s[2];
+                    e.assertData.m_exceptionType = s[3];
+                    e.assertData.m_line          = r.ints[0];
+                    e.assertData.m_kind          = static_cast<AssertData::Kind>(r.ints[1]);
+                    e.assertData.m_passed        = (r.ints[2] & 1) != 0;
+                    e.assertData.m_threw         = (r.ints[2] & 2) != 0;
+                    e.assertData.m_threwAs       = (r.ints[2] & 4) != 0;
+                    e.assertData.m_decomposition = payload.data();
+                    break;
+                case reporterEvent::logBenchmark: {
+                    double stats[4 + perfCounter::count];
+                    for(unsigned i = 0; i < DOCTEST_COUNTOF(stats); ++i)
+                        stats[i] = i < 4 ? 0 : -1;
+                    memcpy(stats, payload.data(), my_min<size_t>(len, sizeof(stats)));
+                    e.benchmark.m_name       = s[0];
+                    e.benchmark.m_file       = s[1];
+                    e.benchmark.m_line       = r.ints[0];
+                    e.benchmark.m_numSamples = static_cast<unsigned>(r.ints[1]);
+                    e.benchmark.m_iterations = static_cast<unsigned>(r.ints[2]);
+                    e.benchmark.m_mean       = stats[0];
+                    e.benchmark.m_median     = stats[1];
+                    e.benchmark.m_stddev     = stats[2];
+                    e.benchmark.m_min        = stats[3];
+                    memcpy(e.benchmark.m_perfCounters, stats + 4,
+                           sizeof(e.benchmark.m_perfCounters));
+                    break;
+                }
+                case reporterEvent::runEnd:
+                    hasRunEnd                    = true;
+                    logged.m_numTestCases        = static_cast<unsigned>(r.ints[0]);
+                    logged.m_numFailedTestCases  = static_cast<unsigned>(r.ints[1]);
+                    logged.m_numAssertions       = r.ints[2];
+                    logged.m_numFailedAssertions = r.ints[3];
+                    continue;
+                default: continue; // the wrap marker of the ring buffer is never written
+            }
+
+            if(skipping || (e.type == reporterEvent::logAssert && e.assertData.m_passed &&
+                            !p->success))
+                continue;
+
+            if(e.type == reporterEvent::testCaseEnd) {
+                decoded.m_numTestCases++;
+                decoded.m_numFailedTestCases += e.testCaseStats.m_failed ? 1 : 0;
+                decoded.m_numAssertions += e.testCaseStats.m_numAssertions;
+                decoded.m_numFailedAssertions += e.testCaseStats.m_numFailedAssertions;
+            }
+            reportEvent(e);
+        }
+        fclose(f);
+
+        // the end of the run is the last record - without it the log has been cut short (the run
+        // crashed or the file is incomplete) and the totals are only of what has been decoded
+        isCorrupt = isCorrupt || !hasRunEnd;
+        if(isCorrupt) {
+            String msg = String("\"") + p->decode_log + "\" is truncated or corrupt";
+            DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
+            writeOutput((msg + " - decoded only up to there\n").c_str());
+        }
+
+        // the totals from the log also count the tests which weren't executed (--dt-first, etc.)
+        ReporterEvent end = makeEvent(reporterEvent::runEnd);
+        end.runStats      = !isCorrupt && !hasSkipped ? logged : decoded;
+        reportEvent(end);
+
+        for(unsigned i = 0; i < strings.size(); ++i)
+            delete[] strings[i];
+        return decoded.m_numFailedTestCases + (isCorrupt ? 1 : 0);
+    }
+
+    // the implementation of parseFlag()
+    bool parseFlagImpl(int argc, const char* const* argv, const char* pattern) {
+        for(int i = argc - 1; i >= 0; --i) {
+            const char* temp = strstr(argv[i], pattern);
+            if(temp && my_strlen(temp) == my_strlen(pattern)) {
+                // eliminate strings in which the chars before the option are not '-'
+                bool noBadCharsFound = true;
+                while(temp != argv[i]) {
+                    if(*--temp != '-') {
+                        noBadCharsFound = false;
+                        break;
+                    }
+                }
+                if(noBadCharsFound)
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    // locates a flag on the command line
+    bool parseFlag(int argc, const char* const* argv, const char* pattern) {
+#ifndef DOCTEST_CONFIG_NO_UNPREFIXED_OPTIONS
+        if(!parseFlagImpl(argc, argv, pattern))
+            return parseFlagImpl(argc, argv, pattern + 3); // 3 for "dt-"
+        return true;
+#else  // DOCTEST_CONFIG_NO_UNPREFIXED_OPTIONS
+        return parseFlagImpl(argc, argv, pattern);
+#endif // DOCTEST_CONFIG_NO_UNPREFIXED_OPTIONS
+    }
+
+    // the implementation of parseOption()
+    bool parseOptionImpl(int argc, const char* const* argv, const char* pattern, String& res) {
+        for(int i = argc - 1; i >= 0; --i) {
+            const char* temp = strstr(argv[i], pattern);
+            if(temp) {
+                // eliminate matches in which the chars before the option are not '-'
+                bool        noBadCharsFound = true;
+                const char* curr            = argv[i];
+                while(curr != temp) {
+                    if(*curr++ != '-') {
+                        noBadCharsFound = false;
+                        break;
+                    }
+                }
+                if(noBadCharsFound) {
+                    temp += my_strlen(pattern);
+                    unsigned len = my_strlen(temp);
+                    if(len) {
+                        res = temp;
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    // parses an option and returns the string after the '=' character
+    bool parseOption(int argc, const char* const* argv, const char* pattern, String& res,
+                     const String& defaultVal = String()) {
+        res = defaultVal;
+#ifndef DOCTEST_CONFIG_NO_UNPREFIXED_OPTIONS
+        if(!parseOptionImpl(argc, argv, pattern, res))
+            return parseOptionImpl(argc, argv, pattern + 3, res); // 3 for "dt-"
+        return true;
+#else // DOCTEST_CONFIG_NO_UNPREFIXED_OPTIONS
+        return parseOptionImpl(argc, argv, pattern, res);
+#endif // DOCTEST_CONFIG_NO_UNPREFIXED_OPTIONS
+    }
+
+    // parses a comma separated list of words after a pattern in one of the arguments in argv
+    bool parseCommaSepArgs(int argc, const char* const* argv, const char* pattern,
+                           Vector<String>& res) {
+        String filtersString;
+        if(parseOption(argc, argv, pattern, filtersString)) {
+            // tokenize with "," as a separator
+            char* pch = strtok(filtersString.c_str(), ","); // modifies the string
+            while(pch != 0) {
+                if(my_strlen(pch))
+                    res.push_back(pch);
+                pch = strtok(0, ","); // uses the strtok() internal state to go to the next token
+            }
+            return true;
+        }
+        return false;
+    }
+
+    // if a reporter has been selected with --dt-reporters
+    bool isReporterSelected(const ContextState* p, const char* name) {
+        for(unsigned i = 0; i < p->reporter_names.size(); ++i)
+            if(p->reporter_names[i].compare(name, true) == 0)
+                return true;
+        return false;
+    }
+
+    enum optionType
+    {
+        option_bool,
+        option_int
+    };
+
+    // parses an int/bool option from the command line
+    bool parseIntOption(int argc, const char* const* argv, const char* pattern, optionType type,
+                        int& res) {
+        String parsedValue;
+        if(parseOption(argc, argv, pattern, parsedValue)) {
+            if(type == 0) {
+                // boolean
+                const char positive[][5] = {"1", "true", "on", "yes"};  // 5 - strlen("true") + 1
+                const char negative[][6] = {"0", "false", "off", "no"}; // 6 - strlen("false") + 1
+
+                // if the value matches any of the positive/negative possibilities
+                for(unsigned i = 0; i < 4; i++) {
+                    if(parsedValue.compare(positive[i], true) == 0) {
+                        res = 1;
+                        return true;
+                    }
+                    if(parsedValue.compare(negative[i], true) == 0) {
+                        res = 0;
+                        return true;
+                    }
+                }
+            } else {
+                // integer - a 0 is valid only when written as such (--dt-benchmark-samples=0)
+                int theInt = atoi(parsedValue.c_str());
+                if(theInt != 0 || parsedValue.compare("0") == 0) {
+                    res = theInt;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void printVersion() {
+        DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
+        writeOutput("doctest version is \"" DOCTEST_VERSION "\"\n");
+    }
+
+    void printHelp() {
+        // clang-format off
+        printVersion();
+        DOCTEST_PRINTF_COLORED("[doctest]\n", Color::Cyan);
+        DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
+        writeOutput("boolean values: \"1/on/yes/true\" or \"0/off/no/false\"\n");
+        DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
+        writeOutput("filter  values: \"str1,str2,str3\" (comma separated strings)\n");
+        DOCTEST_PRINTF_COLORED("[doctest]\n", Color::Cyan);
+        DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
+        writeOutput("filters use wildcards for matching strings\n");
+        DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
+        writeOutput("something passes a filter if any of the strings in a filter matches\n");
+        DOCTEST_PRINTF_COLORED("[doctest]\n", Color::Cyan);
+        DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
+        writeOutput("ALL FLAGS, OPTIONS AND FILTERS ALSO AVAILABLE WITH A \"dt-\" PREFIX!!!\n");
+        DOCTEST_PRINTF_COLORED("[doctest]\n", Color::Cyan);
+        DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
+        writeOutput("Query flags - the program quits after them. Available:\n\n");
+        writeOutput(" -?,   --help, -h                      prints this message\n");
+        writeOutput(" -v,   --version                       prints the version\n");
+        writeOutput(" -c,   --count                         prints the number of matching tests\n");
+        writeOutput(" -ltc, --list-test-cases               lists all matching tests by name\n");
+        writeOutput(" -lts, --list-test-suites              lists all matching test suites\n\n");
+        // ==================================================================================== << 79
+        DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
+        writeOutput("The available <int>/<string> options/filters are:\n\n");
+        writeOutput(" -tc,  --test-case=<filters>           filters     tests by their name\n");
+        writeOutput(" -tce, --test-case-exclude=<filters>   filters OUT tests by their name\n");
+        writeOutput(" -sf,  --source-file=<filters>         filters     tests by their file\n");
+        writeOutput(" -sfe, --source-file-exclude=<filters> filters OUT tests by their file\n");
+        writeOutput(" -ts,  --test-suite=<filters>          filters     tests by their test suite\n");
+        writeOutput(" -tse, --test-suite-exclude=<filters>  filters OUT tests by their test suite\n");
+        writeOutput(" -sc,  --subcase=<filters>             filters     subcases by their path\n");
+        writeOutput(" -sce, --subcase-exclude=<filters>     filters OUT subcases by their path\n");
+        writeOutput(" -ob,  --order-by=<string>             how the tests should be ordered\n");
+        writeOutput("                                       <string> - by [file/suite/name/rand]\n");
+        writeOutput(" -rs,  --rand-seed=<int>               seed for random ordering\n");
+        writeOutput(" -f,   --first=<int>                   the first test passing the filters to\n");
+        writeOutput("                                       execute - for range-based execution\n");
+        writeOutput(" -l,   --last=<int>                    the last test passing the filters to\n");
+        writeOutput("                                       execute - for range-based execution\n");
+        writeOutput(" -aa,  --abort-after=<int>             stop after <int> failed assertions\n");
+        writeOutput(" -to,  --timeout=<int>                 the time limit of each test in seconds\n");
+        writeOutput(" -j,   --jobs=<int>                    execute the tests with <int> threads\n");
+        writeOutput(" -w,   --workers=<int>                 execute the tests with <int> processes\n");
+        writeOutput(" -i,   --isolate=<string>              execute each test in a process of its\n");
+        writeOutput("                                       own - <string> - [fork] (UNIX only)\n");
+        writeOutput(" -df,  --durations-file=<string>       file with durations of tests for ordering\n");
+        writeOutput("                                       them with --jobs and --workers\n");
+        writeOutput(" -sl,  --slowest=<int>                 the number of slowest tests to print\n");
+        writeOutput("                                       with --durations - 10 by default\n");
+        writeOutput(" -bs,  --benchmark-samples=<int>       the number of measured samples of each\n");
+        writeOutput("                                       benchmark - 10 by default (0 executes\n");
+        writeOutput("                                       the body of benchmarks only once)\n");
+        writeOutput(" -bt,  --benchmark-time=<int>          the target duration of a sample of a\n");
+        writeOutput("                                       benchmark in ms - 10 by default\n");
+        writeOutput(" -bo,  --benchmark-out=<string>        file for recording the results of\n");
+        writeOutput("                                       benchmarks\n");
+        writeOutput(" -bb,  --benchmark-baseline=<string>   results recorded by a previous run -\n");
+        writeOutput("                                       slower benchmarks fail\n");
+        writeOutput(" -bth, --benchmark-threshold=<int>     how many percent slower than in the\n");
+        writeOutput("                                       baseline is fine - 10 by default\n");
+        writeOutput(" -bc,  --benchmark-confidence=<int>    the confidence (in percent) for failing\n");
+        writeOutput("                                       slower benchmarks - 95 by default\n");
+        writeOutput(" -pc,  --perf-counters=<filters>       events counted for tests and benchmarks\n");
+        writeOutput("                                       (Linux only) - <filters> of [cycles/\n");
+        writeOutput("                                       instructions/cache-references/\n");
+        writeOutput("                                       cache-misses/branches/branch-misses/\n");
+        writeOutput("                                       page-faults/context-switches]\n");
+        writeOutput(" -r,   --reporters=<filters>           reporters to use - console by default\n");
+        writeOutput("                                       <filters> - of [console/junit/binlog]\n");
+        writeOutput(" -o,   --out=<string>                  file for the junit/binlog reporter\n");
+        writeOutput(" -dl,  --decode-log=<string>           report the tests from a binary log\n");
+        writeOutput("                                       instead of running them\n\n");
+        DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
+        writeOutput("Bool options - can be used like flags and true is assumed. Available:\n\n");
+        writeOutput(" -s,   --success=<bool>                include successful assertions in output\n");
+        writeOutput(" -cs,  --case-sensitive=<bool>         filters being treated as case sensitive\n");
+        writeOutput(" -e,   --exit=<bool>                   exits after the tests finish\n");
+        writeOutput(" -no,  --no-overrides=<bool>           disables procedural overrides of options\n");
+        writeOutput(" -nt,  --no-throw=<bool>               skips exceptions-related assert checks\n");
+        writeOutput(" -ne,  --no-exitcode=<bool>            returns (or exits) always with success\n");
+        writeOutput(" -nr,  --no-run=<bool>                 skips all runtime doctest operations\n");
+        writeOutput(" -nc,  --no-colors=<bool>              disables colors in output\n");
+        writeOutput(" -nb,  --no-breaks=<bool>              disables breakpoints in debuggers\n");
+        writeOutput(" -npf, --no-path-filenames=<bool>      only filenames and no paths in output\n");
+        writeOutput(" -ar,  --async-reporters=<bool>        output is formatted and written by a\n");
+        writeOutput("                                       separate thread - the tests don't wait\n");
+        writeOutput(" -d,   --durations=<bool>              prints the wall clock and CPU time of\n");
+        writeOutput("                                       tests and a table of the slowest ones\n");
+        writeOutput(" -al,  --allocations=<bool>            prints the allocations of tests (with\n");
+        writeOutput("                                       DOCTEST_CONFIG_TRACK_ALLOCATIONS)\n");
+        writeOutput(" -fs,  --fork-subcases=<bool>          subcases are entered by forked\n");
+        writeOutput("                                       processes so the code before them is\n");
+        writeOutput("                                       executed only once (UNIX only)\n");
+        writeOutput(" -ps,  --parallel-subcases=<bool>      the paths through the subcases of a\n");
+        writeOutput("                                       test are split among the threads of\n");
+        writeOutput("                                       --jobs as separate work items\n\n");
+        // ==================================================================================== << 79
+
+        DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
+        writeOutput("for more information visit the project documentation\n\n");
+        // clang-format on
+    }
+
+    // returns a monotonic time in seconds - used for measuring the durations of tests
+    double getCurrentTime() {
+#if defined(DOCTEST_PLATFORM_WINDOWS)
+        LARGE_INTEGER frequency, counter;
+        QueryPerformanceFrequency(&frequency);
+        QueryPerformanceCounter(&counter);
+        return static_cast<double>(counter.QuadPart) / static_cast<double>(frequency.QuadPart);
+#elif defined(CLOCK_MONOTONIC)
+        timespec t;
+        clock_gettime(CLOCK_MONOTONIC, &t);
+        return static_cast<double>(t.tv_sec) + static_cast<double>(t.tv_nsec) * 1e-9;
+#else  // CLOCK_MONOTONIC
+        timeval t;
+        gettimeofday(&t, 0);
+        return static_cast<double>(t.tv_sec) + static_cast<double>(t.tv_usec) * 1e-6;
+#endif // CLOCK_MONOTONIC
+    }
+
+    // returns the CPU time of the current thread in seconds - of the thread and not the process so
+    // the tests executed in parallel with --dt-jobs don't count in the time of each other
+    double getCurrentCpuTime() {
+#if defined(DOCTEST_PLATFORM_WINDOWS)
+        FILETIME creation, exit, kernel, user;
+        if(!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+            return 0;
+        ULARGE_INTEGER k, u;
+        k.LowPart  = kernel.dwLowDateTime;
+        k.HighPart = kernel.dwHighDateTime;
+        u.LowPart  = user.dwLowDateTime;
+        u.HighPart = user.dwHighDateTime;
+        return static_cast<double>(k.QuadPart + u.QuadPart) * 1e-7; // in 100 nanosecond units
+#elif defined(CLOCK_THREAD_CPUTIME_ID)
+        timespec t;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+        return static_cast<double>(t.tv_sec) + static_cast<double>(t.tv_nsec) * 1e-9;
+#else  // CLOCK_THREAD_CPUTIME_ID
+        return static_cast<double>(clock()) / CLOCKS_PER_SEC;
+#endif // CLOCK_THREAD_CPUTIME_ID
+    }
+
+    // the events of --dt-perf-counters which can be counted - the unknown ones and the ones which
+    // can't be opened (if 'probe' is set) are reported
+    unsigned getPerfCounters(const Vector<String>& names, bool probe) {
+        unsigned mask = 0;
+        for(unsigned i = 0; i < names.size(); ++i) {
+            unsigned which = 0;
+            while(which < perfCounter::count &&
+                  names[i].compare(perfCounterNames[which], true) != 0)
+                ++which;
+
+            const char* problem = 0;
+            if(which == perfCounter::count) {
+                problem = "unknown event";
+            } else if(probe) {
+#if defined(__linux__)
+                int fd = openPerfCounter(which, -1);
+                if(fd != -1)
+                    close(fd);
+                else if(errno == ENOENT || errno == EOPNOTSUPP)
+                    problem = "not supported by the CPU or the kernel";
+                else if(errno == EACCES || errno == EPERM)
+                    problem = "not permitted (see /proc/sys/kernel/perf_event_paranoid)";
+                else
+                    problem = strerror(errno);
+#else  // __linux__
+                problem = "supported only on Linux";
+#endif // __linux__
+            }
+            if(!problem) {
+                mask |= 1u << which;
+                continue;
+            }
+
+            char buff[DOCTEST_SNPRINTF_BUFFER_LENGTH];
+            DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff),
+                             "the perf counter \"%s\" is not counted - %s\n", names[i].c_str(),
+                             problem);
+            DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
+            writeOutput(buff);
+        }
+        return mask;
+    }
+
+    // the phases of a benchmark - each one is a batch (or more) of iterations of its body
+    namespace benchmarkPhase
+    {
+        enum Enum
+        {
+            start = 0,
+            once, // with --dt-benchmark-samples=0 the body is executed once and isn't measured
+            calibration,
+            warmup,
+            sampling,
+            done
+        };
+    } // namespace benchmarkPhase
+
+    // the iterations for a sample are at most this many - for bodies which were optimized away
+    const unsigned benchmarkMaxIterations = 1u << 30;
+
+    Benchmark::Benchmark(const char* name, const char* file, int line)
+            : m_name(name)
+            , m_file(file)
+            , m_line(line)
+            , m_phase(benchmarkPhase::start)
+            , m_left(0)
+            , m_iterations(1)
+            , m_batchStart(0)
+            , m_sampleTime(0)
+            , m_numSamples(0)
+            , m_numMeasured(0)
+            , m_samples(0)
+            , m_perfCounters(0) {
+        ContextState* p = getContextState();
+        m_numSamples    = static_cast<unsigned>(my_max(p->benchmark_samples, 0));
+        m_sampleTime    = my_max(p->benchmark_time, 1) / 1000.0;
+        if(m_numSamples)
+            m_samples = static_cast<double*>(malloc(sizeof(double) * m_numSamples));
+        if(m_numSamples && p->perfCounters)
+            m_perfCounters = static_cast<PerfCounters*>(malloc(sizeof(PerfCounters)));
+    }
+
+    Benchmark::~Benchmark() {
+        // the counters are still open if the body threw
+        if(m_perfCounters && m_phase == benchmarkPhase::sampling)
+            stopPerfCounters(*m_perfCounters);
+        free(m_perfCounters);
+        free(m_samples);
+    }
+
+    // the quantile function of the standard normal distribution for 0.5 <= p < 1 (with an error
+    // below 5e-4) - the rational approximation 26.2.23 from Abramowitz and Stegun
+    double normalQuantile(double p) {
+        double t = std::sqrt(-2 * std::log(1 - p));
+        return t - (2.515517 + t * (0.802853 + t * 0.010328)) /
+                           (1 + t * (1.432788 + t * (0.189269 + t * 0.001308)));
+    }
+
+    // the quantile function of Student's t-distribution - the Cornish-Fisher expansion around
+    // the normal distribution (it is good for the degrees of freedom of several samples and up)
+    double studentQuantile(double p, double dof) {
+        double z  = normalQuantile(p);
+        double z2 = z * z;
+        return z + z * (z2 + 1) / (4 * dof) + z * (5 * z2 * z2 + 16 * z2 + 3) / (96 * dof * dof) +
+               z * (3 * z2 * z2 * z2 + 19 * z2 * z2 + 17 * z2 - 15) / (384 * dof * dof * dof);
+    }
+
+    // if the mean of the samples of a benchmark is greater than the (scaled) mean from the
+    // baseline with the given confidence - a one-sided Welch's t-test
+    bool isSlowerThanBaseline(const BenchmarkData& bd, const RecordedBenchmark& base,
+                              double scale, double confidence) {
+        double limit = base.mean * scale;
+        if(bd.m_mean <= limit)
+            return false;
+
+        double var     = bd.m_numSamples > 0 ? bd.m_stddev * bd.m_stddev / bd.m_numSamples : 0;
+        double baseDev = base.stddev * scale;
+        double baseVar = base.numSamples > 0 ? baseDev * baseDev / base.numSamples : 0;
+        if(var + baseVar <= 0)
+            return true; // no noise at all
+
+        // the Welch-Satterthwaite equation
+        double denom = (bd.m_numSamples > 1 ? var * var / (bd.m_numSamples - 1) : 0) +
+                       (base.numSamples > 1 ? baseVar * baseVar / (base.numSamples - 1) : 0);
+        double dof = denom > 0 ? (var + baseVar) * (var + baseVar) / denom : 1e9;
+
+        double t = (bd.m_mean - limit) / std::sqrt(var + baseVar);
+        return t > studentQuantile(confidence, my_max(dof, 1.0));
+    }
+
+    // compares a benchmark with the same one from --dt-benchmark-baseline - it is checked like an
+    // assert which fails if the benchmark is slower by more than --dt-benchmark-threshold
+    void checkBenchmarkBaseline(ContextState* p, const BenchmarkData& bd) {
+        RecordedBenchmark        key  = {bd.m_file, p->currentTest->m_name, bd.m_name, 0, 0, 0};
+        const RecordedBenchmark* base = findRecordedBenchmark(
+                *p->benchmarkBaseline, p->benchmarkBaseline->size(), key);
+        if(!base)
+            return;
+
+        double scale      = 1 + my_max(p->benchmark_threshold, 0) / 100.0;
+        double confidence = my_min(my_max(p->benchmark_confidence / 100.0, 0.5), 0.999);
+        bool   passed     = !isSlowerThanBaseline(bd, *base, scale, confidence);
+
+        double      unitScale = 1;
+        const char* unit      = getDurationUnit(base->mean, unitScale);
+        char        buff[DOCTEST_SNPRINTF_BUFFER_LENGTH];
+        DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff),
+                         "mean %.3f %s vs %.3f %s in the baseline (%+.1f%%)",
+                         bd.m_mean * unitScale, unit, base->mean * unitScale, unit,
+                         base->mean > 0 ? (bd.m_mean / base->mean - 1) * 100 : 0.0);
+        logBinaryAssert(passed, buff, false, bd.m_name, "BENCHMARK", bd.m_file, bd.m_line);
+    }
+
+    void reportBenchmark(const Benchmark& b) {
+        // sorted for the median (and the min) - there aren't many samples
+        Vector<double> sorted;
+        double         sum = 0;
+        for(unsigned i = 0; i < b.m_numMeasured; ++i) {
+            sorted.push_back(b.m_samples[i]);
+            for(unsigned k = i; k > 0 && sorted[k - 1] > sorted[k]; --k) {
+                double temp   = sorted[k - 1];
+                sorted[k - 1] = sorted[k];
+                sorted[k]     = temp;
+            }
+            sum += b.m_samples[i];
+        }
+
+        unsigned n    = sorted.size();
+        double   mean = sum / n;
+        double   sq   = 0;
+        for(unsigned i = 0; i < n; ++i)
+            sq += (sorted[i] - mean) * (sorted[i] - mean);
+
+        ReporterEvent e          = makeEvent(reporterEvent::logBenchmark);
+        e.benchmark.m_name       = b.m_name;
+        e.benchmark.m_file       = b.m_file;
+        e.benchmark.m_line       = b.m_line;
+        e.benchmark.m_numSamples = n;
+        e.benchmark.m_iterations = b.m_iterations;
+        e.benchmark.m_mean       = mean;
+        e.benchmark.m_median     = n % 2 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+        e.benchmark.m_stddev     = n > 1 ? std::sqrt(sq / (n - 1)) : 0;
+        e.benchmark.m_min        = sorted[0];
+        for(unsigned i = 0; i < perfCounter::count; ++i) {
+            double value = b.m_perfCounters ? b.m_perfCounters->values[i] : -1;
+            e.benchmark.m_perfCounters[i] = value < 0 ? -1 : value / (n * b.m_iterations);
+        }
+        reportEvent(e);
+
+        ContextState* p = getContextState();
+        if(p->benchmarkBaseline && p->currentTest)
+            checkBenchmarkBaseline(p, e.benchmark);
+    }
+
+    // called when a batch of iterations ends (and before the first one) - starts the next batch
+    bool Benchmark::nextBatch() {
+        double elapsed = getCurrentTime() - m_batchStart;
+        switch(m_phase) {
+            case benchmarkPhase::start:
+                m_phase = m_numSamples ? benchmarkPhase::calibration : benchmarkPhase::once;
+                break;
+            case benchmarkPhase::calibration:
+                // more iterations until a batch takes long enough - scaled based on the last one
+                if(elapsed < m_sampleTime && m_iterations < benchmarkMaxIterations) {
+                    double scale = elapsed > 0 ? m_sampleTime * 1.2 / elapsed : 10;
+                    double next  = m_iterations * my_min(my_max(scale, 1.5), 10.0);
+                    m_iterations = next < benchmarkMaxIterations ? static_cast<unsigned>(next) :
+                                                                   benchmarkMaxIterations;
+                } else {
+                    m_phase = benchmarkPhase::warmup;
+                }
+                break;
+            case benchmarkPhase::warmup:
+                m_phase = benchmarkPhase::sampling;
+                if(m_perfCounters)
+                    startPerfCounters(*m_perfCounters, getContextState()->perfCounters);
+                break;
+            case benchmarkPhase::sampling:
+                m_samples[m_numMeasured++] = elapsed / m_iterations;
+                if(m_numMeasured == m_numSamples) {
+                    m_phase = benchmarkPhase::done;
+                    if(m_perfCounters)
+                        stopPerfCounters(*m_perfCounters);
+                    reportBenchmark(*this);
+                    return false;
+                }
+                break;
+            default: m_phase = benchmarkPhase::done; return false; // once and done
+        }
+
+        m_left       = m_iterations - 1;
+        m_batchStart = getCurrentTime();
+        return true;
+    }
+
+    // the time limit of a test in seconds - its own or the one from --dt-timeout (0 for none)
+    double getTimeout(const ContextState* p, const TestData& data) {
+        if(data.m_timeout < 0)
+            return 0;
+        return data.m_timeout > 0 ? data.m_timeout : static_cast<double>(p->timeout);
+    }
+
+    // the time limits of tests are watched by these - they are defined along with the crash
+    // handling because a test which runs over its limit is reported like one which crashed
+    Watchdog* startWatchdog(const ContextState* p, const Vector<const TestData*>& tests);
+    void      stopWatchdog(Watchdog* watchdog);
+    void      watchTest(ContextState* p, const TestData& data);
+    void      unwatchTest(ContextState* p);
+
+    // executes a test case (once for each of its subcases) - returns true if the test case failed
+    bool runTestCase(ContextState* p, const TestData& data) {
+        p->currentTest = &data;
+        p->setLastAssert(0, 0);
+        watchTest(p, data);
+
+        ReporterEvent e      = makeEvent(reporterEvent::testCaseStart);
+        e.testCase           = getTestCaseData(data);
+        double start         = getCurrentTime();
+        bool   measureCpu    = p->durations; // the CPU time is not as cheap to query
+        double cpuStart      = measureCpu ? getCurrentCpuTime() : 0;
+        int    numAssertions = p->numAssertions;
+        int    numFailed     = p->numFailedAssertions;
+        reportEvent(e);
+
+        unsigned      didFail        = 0;
+        unsigned      numRuns        = 0;
+        unsigned      numAllocations = 0;
+        unsigned long allocatedBytes = 0;
+        unsigned long peakBytes      = 0;
+        double        perfCounters[perfCounter::count];
+        for(unsigned i = 0; i < perfCounter::count; ++i)
+            perfCounters[i] = -1;
+        resetSubcaseTree(p, data);
+#ifndef DOCTEST_PLATFORM_WINDOWS
+        // with --dt-fork-subcases the runs are executed (and their events sent) by forked processes
+        if(!p->fork_subcases || !runSubcasesInProcesses(p, data, e, didFail))
+#endif // DOCTEST_PLATFORM_WINDOWS
+            do {
+                if(numRuns++ > 0) {
+                    e.type = reporterEvent::testCaseReenter;
+                    reportEvent(e);
+                }
+
+                double iterationStart    = getCurrentTime();
+                double iterationCpuStart = measureCpu ? getCurrentCpuTime() : 0;
+
+                // reset the assertion state
+                p->numAssertionsForCurrentTestcase       = 0;
+                p->numFailedAssertionsForCurrentTestcase = 0;
+
+                // the passed subcases are kept in the tree between the runs
+                startSubcaseRun(p);
+
+                // execute the test
+                PerfCounters counters;
+                startPerfCounters(counters, p->perfCounters);
+                startAllocationTracking();
+                int iterationFailed = callTestFunc(data.m_f);
+                stopAllocationTracking(e.testCaseStats);
+                stopPerfCounters(counters);
+                didFail += iterationFailed;
+                numAllocations += e.testCaseStats.m_numAllocations;
+                allocatedBytes += e.testCaseStats.m_allocatedBytes;
+                peakBytes = my_max(peakBytes, e.testCaseStats.m_peakAllocatedBytes);
+                for(unsigned i = 0; i < perfCounter::count; ++i) {
+                    e.testCaseStats.m_perfCounters[i] = counters.values[i];
+                    if(counters.values[i] >= 0)
+                        perfCounters[i] = my_max(perfCounters[i], 0.0) + counters.values[i];
+                }
+                p->numAssertions += p->numAssertionsForCurrentTestcase;
+
+                // exit this loop if enough assertions have failed
+                if(p->abort_after > 0 && p->numFailedAssertions >= p->abort_after)
+                    p->subcasesHasSkipped = false;
+
+                // the durations of the separate executions only matter for tests with subcases
+                if(numRuns > 1 || p->subcasesHasSkipped) {
+                    e.type                                = reporterEvent::testCaseIterationEnd;
+                    e.testCaseStats.m_failed              = iterationFailed != 0;
+                    e.testCaseStats.m_numAssertions       = p->numAssertionsForCurrentTestcase;
+                    e.testCaseStats.m_numFailedAssertions =
+                            p->numFailedAssertionsForCurrentTestcase;
+                    e.testCaseStats.m_duration            = getCurrentTime() - iterationStart;
+                    e.testCaseStats.m_cpuDuration =
+                            measureCpu ? getCurrentCpuTime() - iterationCpuStart : 0;
+                    reportEvent(e);
+                }
+            } while(p->subcasesHasSkipped == true);
+
+        e.type                                = reporterEvent::testCaseEnd;
+        e.testCaseStats.m_failed              = didFail > 0;
+        e.testCaseStats.m_numAssertions       = p->numAssertions - numAssertions;
+        e.testCaseStats.m_numFailedAssertions = p->numFailedAssertions - numFailed;
+        e.testCaseStats.m_duration            = getCurrentTime() - start;
+        e.testCaseStats.m_cpuDuration         = measureCpu ? getCurrentCpuTime() - cpuStart : 0;
+        e.testCaseStats.m_numAllocations      = numAllocations;
+        e.testCaseStats.m_allocatedBytes      = allocatedBytes;
+        e.testCaseStats.m_peakAllocatedBytes  = peakBytes;
+        memcpy(e.testCaseStats.m_perfCounters, perfCounters, sizeof(perfCounters));
+        reportEvent(e);
+
+        unwatchTest(p);
+        p->currentTest = 0; // for the crash handler
+        return didFail > 0;
+    }
+
+#ifndef DOCTEST_CONFIG_NO_MULTITHREADING
+    // a minimal portable mutex - used by the worker threads of --dt-jobs
+    class Mutex
+    {
+#ifdef DOCTEST_PLATFORM_WINDOWS
+        CRITICAL_SECTION m_mutex;
+#else  // DOCTEST_PLATFORM_WINDOWS
+        pthread_mutex_t m_mutex;
+#endif // DOCTEST_PLATFORM_WINDOWS
+
+        Mutex(const Mutex&);
+        Mutex& operator=(const Mutex&);
+
+    public:
+#ifdef DOCTEST_PLATFORM_WINDOWS
+        Mutex() { InitializeCriticalSection(&m_mutex); }
+        ~Mutex() { DeleteCriticalSection(&m_mutex); }
+        void lock() { EnterCriticalSection(&m_mutex); }
+        void unlock() { LeaveCriticalSection(&m_mutex); }
+#else  // DOCTEST_PLATFORM_WINDOWS
+        Mutex() { pthread_mutex_init(&m_mutex, 0); }
+        ~Mutex() { pthread_mutex_destroy(&m_mutex); }
+        void lock() { pthread_mutex_lock(&m_mutex); }
+        void unlock() { pthread_mutex_unlock(&m_mutex); }
+#endif // DOCTEST_PLATFORM_WINDOWS
+    };
+
+    // locks a mutex for the lifetime of the object
+    class MutexLock
+    {
+        Mutex& m_mutex;
+
+        MutexLock(const MutexLock&);
+        MutexLock& operator=(const MutexLock&);
+
+    public:
+        explicit MutexLock(Mutex& mutex)
+                : m_mutex(mutex) {
+            m_mutex.lock();
+        }
+        ~MutexLock() { m_mutex.unlock(); }
+    };
+#else  // DOCTEST_CONFIG_NO_MULTITHREADING
+    // without threads there is nothing to guard
+    class Mutex
+    {
+    public:
+        void lock() {}
+        void unlock() {}
+    };
+
+    class MutexLock
+    {
+    public:
+        explicit MutexLock(Mutex&) {}
+    };
+#endif // DOCTEST_CONFIG_NO_MULTITHREADING
+
+    // a test with its estimated duration - used for sorting the tests longest first
+    struct EstimatedTest
+    {
+        double   estimate;
+        unsigned index;
+    };
+
+    // for sorting tests by estimated duration (longest first) and then by their original order
+    int estimateComparator(const void* a, const void* b) {
+        const EstimatedTest* lhs = static_cast<const EstimatedTest*>(a);
+        const EstimatedTest* rhs = static_cast<const EstimatedTest*>(b);
+
+        if(lhs->estimate > rhs->estimate)
+            return -1;
+        if(lhs->estimate < rhs->estimate)
+            return 1;
+        return lhs->index < rhs->index ? -1 : (lhs->index > rhs->index ? 1 : 0);
+    }
+
+    // hands out the tests to workers (threads or processes) based on their estimated durations.
+    // the tests are dealt longest first to a queue for each worker (always to the one with the
+    // least estimated work) and a worker which runs out of tests steals from the back of the
+    // queue with the most estimated work left - so the long tests start early and the short
+    // ones fill the gaps at the end. Each queue has its own lock so the workers of --dt-jobs only
+    // contend for one when stealing from it
+    class Scheduler
+    {
+        struct Queue
+        {
+            Vector<unsigned> tests; // indexes of tests - in the order they should be executed
+            Vector<double>   estimates; // the estimated duration of each test in 'tests'
+            unsigned         front;     // the first test not handed out yet
+            unsigned         back;      // one past the last test not handed out yet
+            double           work;      // the estimated duration of the tests not handed out
+
+            Queue()
+                    : front(0)
+                    , back(0)
+                    , work(0) {}
+
+            unsigned size() const { return back - front; }
+        };
+
+        Vector<Queue> m_queues;
+        Mutex*        m_locks; // one for each queue
+
+        Scheduler(const Scheduler&);
+        Scheduler& operator=(const Scheduler&);
+
+        // takes the next test from the back of a queue - false if it has none left
+        bool steal(unsigned victim, unsigned& test) {
+            MutexLock lock(m_locks[victim]);
+            Queue&    q = m_queues[victim];
+            if(q.size() == 0)
+                return false;
+            q.back--;
+            q.work -= q.estimates[q.back];
+            test = q.tests[q.back];
+            return true;
+        }
+
+    public:
+        Scheduler(const Vector<double>& estimates, unsigned numWorkers)
+                : m_queues(my_max(numWorkers, 1u))
+                , m_locks(new Mutex[m_queues.size()]) {
+            Vector<EstimatedTest> sorted;
+            for(unsigned i = 0; i < estimates.size(); ++i) {
+                EstimatedTest test = {estimates[i], i};
+                sorted.push_back(test);
+            }
+            if(sorted.size() > 0)
+                qsort(sorted.data(), sorted.size(), sizeof(EstimatedTest), estimateComparator);
+
+            for(unsigned i = 0; i < sorted.size(); ++i) {
+                unsigned target = 0;
+                for(unsigned k = 1; k < m_queues.size(); ++k)
+                    if(m_queues[k].work < m_queues[target].work ||
+                       (!(m_queues[k].work > m_queues[target].work) &&
+                        m_queues[k].size() < m_queues[target].size()))
+                        target = k;
+                Queue& q = m_queues[target];
+                q.tests.push_back(sorted[i].index);
+                q.estimates.push_back(sorted[i].estimate);
+                q.back++;
+                q.work += sorted[i].estimate;
+            }
+        }
+
+        ~Scheduler() { delete[] m_locks; }
+
+        // gives the next test for a worker - returns false if there are no tests left at all
+        bool next(unsigned worker, unsigned& test) {
+            unsigned id = worker % m_queues.size();
+            {
+                MutexLock lock(m_locks[id]);
+                Queue&    own = m_queues[id];
+                if(own.size() > 0) {
+                    own.work -= own.estimates[own.front];
+                    test = own.tests[own.front++];
+                    return true;
+                }
+            }
+
+            // steal from the queue with the most estimated work left - the queues are looked at
+            // one at a time so another worker may empty the victim first (then this is retried)
+            for(;;) {
+                unsigned victim = m_queues.size();
+                double   most   = 0;
+                for(unsigned k = 0; k < m_queues.size(); ++k) {
+                    MutexLock lock(m_locks[k]);
+                    if(m_queues[k].size() > 0 &&
+                       (victim == m_queues.size() || m_queues[k].work > most)) {
+                        victim = k;
+                        most   = m_queues[k].work;
+                    }
+                }
+                if(victim == m_queues.size())
+                    return false;
+                if(steal(victim, test))
+                    return true;
+            }
+        }
+
+        // returns a test which was handed out but couldn't be started - it will be next again
+        void giveBack(unsigned worker, unsigned test) {
+            unsigned id = worker % m_queues.size();
+            {
+                MutexLock lock(m_locks[id]);
+                Queue&    own = m_queues[id];
+                if(own.front > 0 && own.tests[own.front - 1] == test) {
+                    own.front--;
+                    own.work += own.estimates[own.front];
+                    return;
+                }
+            }
+            // the test was stolen from another queue - put it in the slot it was stolen from
+            for(unsigned k = 0; k < m_queues.size(); ++k) {
+                MutexLock lock(m_locks[k]);
+                Queue&    q = m_queues[k];
+                if(q.back < q.tests.size() && q.tests[q.back] == test) {
+                    q.work += q.estimates[q.back];
+                    q.back++;
+                    return;
+                }
+            }
+        }
+    };
+
+    // the results of tests executed out of order (by threads or processes) - reported in order
+    struct OrderedResults
+    {
+        Vector<Vector<char> > events;    // the captured events for reporters of each test
+        Vector<int>           results;   // for each test: 0 - not finished, 1 - passed, 2 - failed
+        Vector<double>        durations; // the duration of each test in seconds
+        unsigned              reported;  // the index of the first test not reported yet
+        bool                  aborted; // set when enough assertions have failed (--dt-abort-after)
+
+        // the totals merged from all tests
+        int      numAssertions;
+        int      numFailedAssertions;
+        unsigned numFailed;
+        unsigned numExecuted;
+
+        explicit OrderedResults(unsigned numTests)
+                : events(numTests)
+                , results(numTests, 0)
+                , durations(numTests, 0.0)
+                , reported(0)
+                , aborted(false)
+                , numAssertions(0)
+                , numFailedAssertions(0)
+                , numFailed(0)
+                , numExecuted(0) {}
+
+        void add(unsigned index, bool failed, const Vector<char>& testEvents, int assertions,
+                 int failedAssertions, double duration, int abort_after) {
+            events[index]    = testEvents;
+            results[index]   = failed ? 2 : 1;
+            durations[index] = duration;
+            numAssertions += assertions;
+            numFailedAssertions += failedAssertions;
+            numFailed += failed ? 1 : 0;
+            numExecuted++;
+            if(abort_after > 0 && numFailedAssertions >= abort_after)
+                aborted = true;
+        }
+
+        // reports the events of the finished tests which are next in order - this is also called
+        // by the worker threads of --dt-jobs (under a lock)
+        void reportFinished(Reporters& reporters) {
+            while(reported < results.size() && results[reported] != 0) {
+                replayEvents(reporters, events[reported]);
+                events[reported].clear();
+                reported++;
+            }
+        }
+
+        // reports what remains (after tests haven't been started because of --dt-abort-after)
+        void reportRest(Reporters& reporters) {
+            for(; reported < results.size(); ++reported)
+                if(results[reported] != 0)
+                    replayEvents(reporters, events[reported]);
+        }
+    };
+
+    // merges the results of tests executed out of order into the totals of the run
+    void mergeResults(ContextState* p, OrderedResults& results, unsigned numTests,
+                      unsigned& numTestsPassingFilters, unsigned& numFailed) {
+        results.reportRest(*p->reporters);
+        p->numAssertions += results.numAssertions;
+        p->numFailedAssertions += results.numFailedAssertions;
+        numFailed += results.numFailed;
+        // same as when serial - tests after the one which triggered --dt-abort-after aren't counted
+        numTestsPassingFilters -= numTests - results.numExecuted;
+    }
+
+    // the duration of a test recorded by a previous run (--dt-durations-file)
+    struct RecordedDuration
+    {
+        const char* file;
+        unsigned    line;
+        double      seconds;
+    };
+
+    // for sorting and searching recorded durations by file/line
+    int recordedDurationComparator(const void* a, const void* b) {
+        const RecordedDuration* lhs = static_cast<const RecordedDuration*>(a);
+        const RecordedDuration* rhs = static_cast<const RecordedDuration*>(b);
+
+        int res = strcmp(lhs->file, rhs->file);
+        if(res != 0)
+            return res;
+        return lhs->line < rhs->line ? -1 : (lhs->line > rhs->line ? 1 : 0);
+    }
+
+    void sortRecordedDurations(Vector<RecordedDuration>& durations) {
+        if(durations.size() > 0)
+            qsort(durations.data(), durations.size(), sizeof(RecordedDuration),
+                  recordedDurationComparator);
+    }
+
+    const RecordedDuration* findRecordedDuration(const Vector<RecordedDuration>& durations,
+                                                 unsigned count, const char* file,
+                                                 unsigned line) {
+        if(count == 0)
+            return 0;
+        RecordedDuration key = {file, line, 0.0};
+        return static_cast<const RecordedDuration*>(bsearch(&key, durations.data(), count,
+                                                            sizeof(RecordedDuration),
+                                                            recordedDurationComparator));
+    }
+
+    // reads the durations of tests recorded by a previous run - one "<seconds> <line> <file>"
+    // per line. The file names point inside 'contents' so it should outlive the result
+    void readDurationsFile(const String& path, String& contents,
+                           Vector<RecordedDuration>& durations) {
+        if(!readFile(path, contents))
+            return;
+
+        char* curr = contents.c_str();
+        while(*curr) {
+            char* end = strchr(curr, '\n');
+            if(end)
+                *end = '\0';
+
+            char*            afterSeconds = 0;
+            char*            afterLine    = 0;
+            RecordedDuration entry;
+            entry.seconds = strtod(curr, &afterSeconds);
+            entry.line    = static_cast<unsigned>(strtoul(afterSeconds, &afterLine, 10));
+
+            char* file = afterLine;
+            if(*file == ' ')
+                file++;
+            // strip a '\r' left from files with windows line endings
+            size_t len = strlen(file);
+            if(len > 0 && file[len - 1] == '\r')
+                file[len - 1] = '\0';
+            entry.file = file;
+
+            // ignore malformed lines
+            if(afterSeconds != curr && afterLine != afterSeconds && *entry.file != '\0' &&
+               entry.seconds >= 0)
+                durations.push_back(entry);
+
+            if(!end)
+                break;
+            curr = end + 1;
+        }
+        sortRecordedDurations(durations);
+    }
+
+    // the estimated duration of each test - the recorded one or the average of the recorded
+    // ones for new tests - so the longest ones get started first
+    Vector<double> getEstimatedDurations(const Vector<const TestData*>& tests,
+                                         const Vector<RecordedDuration>& recorded) {
+        Vector<double> estimates(tests.size(), -1.0);
+        double         total    = 0;
+        unsigned       numKnown = 0;
+        for(unsigned i = 0; i < tests.size(); ++i) {
+            const RecordedDuration* found = findRecordedDuration(
+                    recorded, recorded.size(), tests[i]->m_file, tests[i]->m_line);
+            if(found) {
+                estimates[i] = found->seconds;
+                total += found->seconds;
+                numKnown++;
+            }
+        }
+        double average = numKnown > 0 ? total / numKnown : 1.0;
+        for(unsigned i = 0; i < tests.size(); ++i)
+            if(estimates[i] < 0)
+                estimates[i] = average;
+        return estimates;
+    }
+
+    // writes the durations of the executed tests - keeping those of tests which weren't executed
+    void writeDurationsFile(const String& path, const Vector<const TestData*>& tests,
+                            const OrderedResults& results,
+                            const Vector<RecordedDuration>& recorded) {
+        Vector<RecordedDuration> durations;
+        for(unsigned i = 0; i < tests.size(); ++i) {
+            if(results.results[i] == 0)
+                continue;
+            RecordedDuration entry = {tests[i]->m_file, tests[i]->m_line, results.durations[i]};
+            durations.push_back(entry);
+        }
+        sortRecordedDurations(durations);
+
+        unsigned numExecuted = durations.size();
+        for(unsigned i = 0; i < recorded.size(); ++i)
+            if(!findRecordedDuration(durations, numExecuted, recorded[i].file, recorded[i].line))
+                durations.push_back(recorded[i]);
+        sortRecordedDurations(durations);
+
+        FILE* f = fopen(path.c_str(), "wb");
+        if(!f)
+            return;
+        for(unsigned i = 0; i < durations.size(); ++i)
+            fprintf(f, "%.6f %u %s\n", durations[i].seconds, durations[i].line,
+                    durations[i].file);
+        fclose(f);
+    }
+
+    // executes the tests which haven't been executed yet serially in this thread (in order)
+    void runRemainingTests(ContextState* p, const Vector<const TestData*>& tests,
+                           OrderedResults& results) {
+        for(unsigned i = 0; i < tests.size() && !results.aborted; ++i) {
+            if(results.results[i] != 0)
+                continue;
+            // all tests before this one are finished so its events can go straight to the reporters
+            results.reportFinished(*p->reporters);
+            int numAssertions       = p->numAssertions;
+            int numFailedAssertions = p->numFailedAssertions;
+
+            // start from the global count so --dt-abort-after works the same way as when serial
+            p->numAssertions       = 0;
+            p->numFailedAssertions = results.numFailedAssertions;
+
+            double start  = getCurrentTime();
+            bool   failed = runTestCase(p, *tests[i]);
+            results.add(i, failed, Vector<char>(), p->numAssertions,
+                        p->numFailedAssertions - results.numFailedAssertions,
+                        getCurrentTime() - start, p->abort_after);
+
+            // the totals are in the results now
+            p->numAssertions       = numAssertions;
+            p->numFailedAssertions = numFailedAssertions;
+        }
+        results.reportFinished(*p->reporters);
+    }
+
+#ifndef DOCTEST_PLATFORM_WINDOWS
+    // reads exactly 'size' bytes from a pipe - returns false on error or end of file
+    bool readAll(int fd, void* data, size_t size) {
+        char* bytes = static_cast<char*>(data);
+        while(size > 0) {
+            ssize_t res = read(fd, bytes, size);
+            if(res < 0 && errno == EINTR)
+                continue;
+            if(res <= 0)
+                return false;
+            bytes += res;
+            size -= static_cast<size_t>(res);
+        }
+        return true;
+    }
+
+    // writes exactly 'size' bytes to a pipe - returns false on error
+    bool writeAll(int fd, const void* data, size_t size) {
+        const char* bytes = static_cast<const char*>(data);
+        while(size > 0) {
+            ssize_t res = write(fd, bytes, size);
+            if(res < 0 && errno == EINTR)
+                continue;
+            if(res <= 0)
+                return false;
+            bytes += res;
+            size -= static_cast<size_t>(res);
+        }
+        return true;
+    }
+
+    // with --dt-isolate=fork each test is executed in a process of its own - forked from the one
+    // which has registered the tests and is set up already (UNIX only)
+    bool isolatesTests(const ContextState* p) { return p->isolate.compare("fork", true) == 0; }
+
+    // what the parent sends to a worker process of --dt-workers
+    struct ProcessTask
+    {
+        unsigned index;               // the index of the test to execute
+        int      numFailedAssertions; // the global count - for --dt-abort-after
+    };
+
+    // what a worker process of --dt-workers sends back after a test (followed by its events)
+    struct ProcessResult
+    {
+        unsigned index;
+        int      failed;
+        int      crashed; // the worker process dies after sending this
+        int      numAssertions;
+        int      numFailedAssertions;
+        double   duration;
+        unsigned eventsSize;
+    };
+
+    // a worker process of --dt-workers and the pipes to it as seen from the parent
+    struct WorkerProcess
+    {
+        pid_t  pid;
+        int    taskFd;   // the parent writes tasks to this
+        int    resultFd; // the parent reads results from this
+        int    current;  // the index of the test being executed or -1 if idle
+        double deadline; // when the worker is killed if the test isn't done by then (0 for never)
+
+        WorkerProcess()
+                : pid(-1)
+                , taskFd(-1)
+                , resultFd(-1)
+                , current(-1)
+                , deadline(0) {}
+    };
+
+    // how long after the time limit of a test its worker process is killed by the parent - the
+    // watchdog of the worker should have reported the test by then (unless it can't get to it)
+    const double workerKillDelay = 1.0;
+
+    // the test being executed by this process (if it is a worker of --dt-workers) and the pipe for
+    // its result - so the crash handler can send the events of a test which crashed to the parent
+    struct WorkerProcessState
+    {
+        int         resultFd; // -1 if this isn't a worker process
+        ProcessTask task;
+        double      start;
+    };
+
+    WorkerProcessState& getWorkerProcessState() {
+        static WorkerProcessState state = {-1, {0, 0}, 0};
+        return state;
     }
 
-    void logAssert(bool passed, const char* decomposition, bool threw, const char* expr,
-                   const char* assert_name, const char* file, int line) {
-        char loc[DOCTEST_SNPRINTF_BUFFER_LENGTH];
-        DOCTEST_SNPRINTF(loc, DOCTEST_COUNTOF(loc), "%s(%d)", fileForOutput(file), line);
+    // sends the events of the test which crashed to the parent - if this is a worker process
+    bool sendCrashedTest(ContextState* p) {
+        const WorkerProcessState& state = getWorkerProcessState();
+        if(state.resultFd == -1)
+            return false;
 
-        char msg[DOCTEST_SNPRINTF_BUFFER_LENGTH];
-        if(passed)
-            DOCTEST_SNPRINTF(msg, DOCTEST_COUNTOF(msg), " PASSED!\n");
+        ProcessResult res;
+        res.index               = state.task.index;
+        res.failed              = 1;
+        res.crashed             = 1;
+        res.numAssertions       = p->numAssertions + p->numAssertionsForCurrentTestcase;
+        res.numFailedAssertions = p->numFailedAssertions - state.task.numFailedAssertions;
+        res.duration            = getCurrentTime() - state.start;
+        res.eventsSize          = p->capturedEvents->size();
+        fflush(stdout);
+        writeAll(state.resultFd, &res, sizeof(res));
+        writeAll(state.resultFd, p->capturedEvents->data(), res.eventsSize);
+        return true;
+    }
+
+    // the loop of a worker process - executes the tests the parent sends until the pipe is closed
+    void processWorker(ContextState* p, const Vector<const TestData*>& tests, int taskFd,
+                       int resultFd) {
+        Vector<char> events;
+        p->capturedEvents = &events;
+
+        // the thread of the watchdog of the parent doesn't survive forking
+        if(p->watchdog)
+            p->watchdog = startWatchdog(p, tests);
+
+        WorkerProcessState& state = getWorkerProcessState();
+        state.resultFd            = resultFd;
+        while(readAll(taskFd, &state.task, sizeof(state.task))) {
+            const ProcessTask& task = state.task;
+            events.clear();
+            p->numAssertions       = 0;
+            p->numFailedAssertions = task.numFailedAssertions;
+
+            ProcessResult res;
+            state.start             = getCurrentTime();
+            res.index               = task.index;
+            res.failed              = runTestCase(p, *tests[task.index]) ? 1 : 0;
+            res.crashed             = 0;
+            res.duration            = getCurrentTime() - state.start;
+            res.numAssertions       = p->numAssertions;
+            res.numFailedAssertions = p->numFailedAssertions - task.numFailedAssertions;
+            res.eventsSize          = events.size();
+
+            // the output from the test itself should be seen before the next one starts
+            fflush(stdout);
+
+            if(!writeAll(resultFd, &res, sizeof(res)) ||
+               !writeAll(resultFd, events.data(), res.eventsSize))
+                break;
+        }
+
+        stopWatchdog(p->watchdog);
+        p->watchdog = 0;
+    }
+
+    // with --dt-fork-subcases the test function is called by a forked process which at the entry
+    // of each subcase forks one more to enter it and waits there - when the child is done and a
+    // sibling of the subcase was skipped it goes on with a new run for it (otherwise it ends). So
+    // the code before a subcase is executed once and not once for each path through the ones in
+    // it. All of them send their events to the process executing the test which reports them
+    struct SubcaseProcessState
+    {
+        int  messageFd; // to the process executing the test (-1 if this isn't a forked one)
+        int  treeFd;    // the tree of subcases goes through this to the parent when done
+        bool startsRun; // if the next message starts a new run of the test function
+        int  numSentAssertions;       // the counts of the asserts of the test when the last
+        int  numSentFailedAssertions; // message was sent (by this process or the one it forked)
+    };
+
+    SubcaseProcessState& getSubcaseProcessState() {
+        static SubcaseProcessState state = {-1, -1, false, 0, 0};
+        return state;
+    }
+
+    namespace subcaseMessage
+    {
+        enum Enum
+        {
+            events,  // the events so far - sent before forking
+            runEnd,  // the test function has returned
+            crashed  // the process crashed (after reporting it) - the test ends with it
+        };
+    } // namespace subcaseMessage
+
+    // what a process of --dt-fork-subcases sends to the one executing the test (with its events).
+    // The asserts are the ones since the previous message - so the ones before a subcase are
+    // counted once (like their failures are reported once) and not once for each run
+    struct SubcaseMessage
+    {
+        int      type;
+        int      startsRun;
+        int      failed;
+        int      numAssertions;
+        int      numFailedAssertions;
+        unsigned eventsSize;
+    };
+
+    // a process of --dt-fork-subcases doesn't outlive the one which forked it (Linux only)
+    void dieWithParent() {
+#ifdef __linux__
+        prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif // __linux__
+    }
+
+    void sendSubcaseMessage(ContextState* s, subcaseMessage::Enum type, int failed) {
+        SubcaseProcessState& state = getSubcaseProcessState();
+        SubcaseMessage       msg;
+        msg.type                = type;
+        msg.startsRun           = state.startsRun ? 1 : 0;
+        msg.failed              = failed;
+        msg.numAssertions       = s->numAssertionsForCurrentTestcase - state.numSentAssertions;
+        msg.numFailedAssertions =
+                s->numFailedAssertionsForCurrentTestcase - state.numSentFailedAssertions;
+        msg.eventsSize = s->capturedEvents->size();
+        state.numSentAssertions       = s->numAssertionsForCurrentTestcase;
+        state.numSentFailedAssertions = s->numFailedAssertionsForCurrentTestcase;
+        fflush(stdout);
+        writeAll(state.messageFd, &msg, sizeof(msg));
+        writeAll(state.messageFd, s->capturedEvents->data(), msg.eventsSize);
+        s->capturedEvents->clear();
+        state.startsRun = false;
+    }
+
+    // ends a process of --dt-fork-subcases - the parent gets the tree of subcases with the last
+    // run in it (unless this one has crashed or its child has)
+    void endSubcaseProcess(ContextState* s, bool sendTree) {
+        SubcaseProcessState& state = getSubcaseProcessState();
+        if(sendTree && state.treeFd != -1) {
+            unsigned header[2] = {s->subcasesRun, s->subcaseTree.size()};
+            writeAll(state.treeFd, header, sizeof(header));
+            writeAll(state.treeFd, s->subcaseTree.data(), header[1] * sizeof(SubcaseNode));
+        }
+        fflush(stdout);
+        _exit(EXIT_SUCCESS); // no destructors of globals (or of the locals of the test function)
+    }
+
+    // starts a new run in a process of --dt-fork-subcases which waited in a subcase - the ones it
+    // is in are entered in this run too and are reported again
+    void resumeSubcaseRun(ContextState* s, unsigned node) {
+        if(node == 0)
+            return;
+        const SubcaseNode& sc = s->subcaseTree[node];
+        s->subcaseTree[sc.parent].childEnteredRun = s->subcasesRun;
+        resumeSubcaseRun(s, sc.parent);
+
+        ReporterEvent e  = makeEvent(reporterEvent::subcaseStart);
+        e.subcase.m_name = sc.name;
+        e.subcase.m_file = sc.file;
+        e.subcase.m_line = sc.line;
+        reportEvent(e);
+    }
+
+    // sends the events captured (and the asserts counted) so far by a process of
+    // --dt-fork-subcases (if this is one)
+    void sendSubcaseEvents(ContextState* s) {
+        const SubcaseProcessState& state = getSubcaseProcessState();
+        if(state.messageFd != -1 &&
+           (state.startsRun || s->capturedEvents->size() ||
+            s->numAssertionsForCurrentTestcase != state.numSentAssertions))
+            sendSubcaseMessage(s, subcaseMessage::events, 0);
+    }
+
+    // called before entering a subcase - returns true in the forked child which enters it (or if
+    // this isn't a process of --dt-fork-subcases) and false when a sibling of it is next
+    bool forkSubcase(ContextState* s, unsigned parent) {
+        SubcaseProcessState& state = getSubcaseProcessState();
+        if(state.messageFd == -1)
+            return true;
+
+        // the events so far come before the ones of the child
+        sendSubcaseEvents(s);
+
+        int fds[2];
+        if(pipe(fds) != 0)
+            return true;
+
+        // what the test has printed (and is still in the buffers of stdio) would be printed by
+        // the child too
+        fflush(0);
+        pid_t pid = fork();
+        if(pid == 0) {
+            dieWithParent();
+            close(fds[0]);
+            if(state.treeFd != -1)
+                close(state.treeFd);
+            state.treeFd = fds[1];
+            return true;
+        }
+        close(fds[1]);
+        if(pid < 0) {
+            close(fds[0]);
+            return true;
+        }
+
+        unsigned header[2] = {0, 0};
+        bool     received  = readAll(fds[0], header, sizeof(header));
+        if(received) {
+            s->subcaseTree.resize(header[1]);
+            received = readAll(fds[0], s->subcaseTree.data(), header[1] * sizeof(SubcaseNode));
+        }
+        close(fds[0]);
+        while(waitpid(pid, 0, 0) == -1 && errno == EINTR)
+            ;
+
+        // done if the child crashed (the test ends with it) or no sibling was skipped in its run
+        s->subcasesRun = header[0];
+        if(!received || s->subcaseTree[parent].unfinishedRun != s->subcasesRun)
+            endSubcaseProcess(s, received);
+
+        s->subcasesRun++;
+        state.startsRun = true;
+        resumeSubcaseRun(s, parent);
+        return false;
+    }
+
+    // executes a test with --dt-fork-subcases - reports the runs of the test function as the
+    // processes executing them send their events. Returns false if the process couldn't be forked
+    bool runSubcasesInProcesses(ContextState* p, const TestData& data, ReporterEvent& e,
+                                unsigned& didFail) {
+        int fds[2];
+        if(pipe(fds) != 0)
+            return false;
+
+        // see startWorkerProcess()
+        EventRing*& ring = p->reporters->ring;
+        if(ring)
+            ring->waitUntilEmpty();
+        flushOutput(false);
+        fflush(0);
+
+        pid_t pid = fork();
+        if(pid == 0) {
+            // the processes are in a group of their own so they can be killed together
+            setpgid(0, 0);
+            dieWithParent();
+            ring = 0;
+            close(fds[0]);
+            WorkerProcessState& worker = getWorkerProcessState();
+            if(worker.resultFd != -1)
+                close(worker.resultFd);
+            worker.resultFd = -1;
+
+            Vector<char> events;
+            p->capturedEvents          = &events;
+            SubcaseProcessState& state    = getSubcaseProcessState();
+            state.messageFd               = fds[1];
+            state.startsRun               = true;
+            state.numSentAssertions       = 0;
+            state.numSentFailedAssertions = 0;
+
+            // all the processes return from the test function here
+            startSubcaseRun(p);
+            int failed = callTestFunc(data.m_f);
+            sendSubcaseMessage(p, subcaseMessage::runEnd, failed);
+            endSubcaseProcess(p, true);
+        }
+        close(fds[1]);
+        if(pid < 0) {
+            close(fds[0]);
+            return false;
+        }
+        setpgid(pid, pid);
+
+        unsigned       numRuns                = 0;
+        bool           inRun                  = false;
+        double         runStart               = getCurrentTime();
+        int            numRunAssertions       = 0; // the ones reported for the current run
+        int            numRunFailedAssertions = 0;
+        SubcaseMessage msg;
+        Vector<char>   events;
+        for(unsigned i = 0; i < perfCounter::count; ++i)
+            e.testCaseStats.m_perfCounters[i] = -1;
+        while(readAll(fds[0], &msg, sizeof(msg))) {
+            events.resize(msg.eventsSize);
+            if(!readAll(fds[0], events.data(), msg.eventsSize))
+                break;
+
+            // the end of the previous run is reported when it is known that there is a next one
+            if(msg.startsRun) {
+                if(numRuns++ > 0) {
+                    e.type = reporterEvent::testCaseIterationEnd;
+                    reportEvent(e);
+                    e.type = reporterEvent::testCaseReenter;
+                    reportEvent(e);
+                }
+                runStart               = getCurrentTime();
+                inRun                  = true;
+                numRunAssertions       = 0;
+                numRunFailedAssertions = 0;
+            }
+            for(unsigned offset = 0; offset < events.size();) {
+                ReporterEvent event = readRecord(events.data() + offset);
+                offset += event.size;
+                reportEvent(event);
+            }
+            numRunAssertions += msg.numAssertions;
+            numRunFailedAssertions += msg.numFailedAssertions;
+            p->numAssertions += msg.numAssertions;
+            p->numFailedAssertions += msg.numFailedAssertions;
+            if(msg.type == subcaseMessage::events)
+                continue;
+
+            inRun = false;
+            didFail += msg.failed ? 1 : 0;
+            e.testCaseStats.m_failed              = msg.failed != 0;
+            e.testCaseStats.m_numAssertions       = numRunAssertions;
+            e.testCaseStats.m_numFailedAssertions = numRunFailedAssertions;
+            e.testCaseStats.m_duration            = getCurrentTime() - runStart;
+            e.testCaseStats.m_cpuDuration         = 0;
+            if(msg.type == subcaseMessage::crashed ||
+               (p->abort_after > 0 && p->numFailedAssertions >= p->abort_after))
+                break;
+        }
+
+        // a run which didn't end means that a process died without a word - the test ends too
+        if(inRun) {
+            ReporterEvent crash = makeEvent(reporterEvent::testCaseCrashed);
+            crash.testCase      = e.testCase;
+            crash.reason        = "the process executing the subcases died";
+            reportEvent(crash);
+            didFail++;
+        }
+        kill(-pid, SIGKILL);
+        close(fds[0]);
+        while(waitpid(pid, 0, 0) == -1 && errno == EINTR)
+            ;
+
+        if(numRuns > 1) {
+            e.type = reporterEvent::testCaseIterationEnd;
+            reportEvent(e);
+        }
+        return true;
+    }
+
+    void closeWorkerPipes(WorkerProcess& w) {
+        if(w.taskFd != -1)
+            close(w.taskFd);
+        if(w.resultFd != -1)
+            close(w.resultFd);
+        w.taskFd   = -1;
+        w.resultFd = -1;
+    }
+
+    // forks a worker process - returns false if the pipes or the process could not be created
+    bool startWorkerProcess(ContextState* p, const Vector<const TestData*>& tests,
+                            Vector<WorkerProcess>& workers, unsigned which) {
+        int taskPipe[2];
+        int resultPipe[2];
+        if(pipe(taskPipe) != 0)
+            return false;
+        if(pipe(resultPipe) != 0) {
+            close(taskPipe[0]);
+            close(taskPipe[1]);
+            return false;
+        }
+
+        // the thread of --dt-async-reporters shouldn't be in the middle of something when forking
+        // - and the child shouldn't write what has been buffered in the parent until now (also in
+        // the file of the junit reporter) so all streams are flushed
+        EventRing*& ring = p->reporters->ring;
+        if(ring)
+            ring->waitUntilEmpty();
+        flushOutput(false);
+        fflush(0);
+
+        pid_t pid = fork();
+        if(pid == 0) {
+            // threads don't survive forking - the child captures its events anyway
+            ring = 0;
+
+            // the child should not keep the pipes to the other workers open
+            for(unsigned i = 0; i < workers.size(); ++i)
+                closeWorkerPipes(workers[i]);
+            close(taskPipe[1]);
+            close(resultPipe[0]);
+
+            processWorker(p, tests, taskPipe[0], resultPipe[1]);
+
+            fflush(stdout);
+            _exit(EXIT_SUCCESS); // no destructors of globals in the child
+        }
+
+        close(taskPipe[0]);
+        close(resultPipe[1]);
+        if(pid < 0) {
+            close(taskPipe[1]);
+            close(resultPipe[0]);
+            return false;
+        }
+
+        WorkerProcess& w = workers[which];
+        w.pid            = pid;
+        w.taskFd         = taskPipe[1];
+        w.resultFd       = resultPipe[0];
+        w.current        = -1;
+        w.deadline       = 0;
+        return true;
+    }
+
+    // the events for a test during which its worker process died (or was killed)
+    Vector<char> getWorkerDiedEvents(ContextState* p, const TestData& data, const char* reason) {
+        Vector<char> events;
+        p->capturedEvents = &events;
+
+        ReporterEvent e = makeEvent(reporterEvent::testCaseStart);
+        e.testCase      = getTestCaseData(data);
+        reportEvent(e);
+        e.type   = reporterEvent::testCaseCrashed;
+        e.reason = reason;
+        reportEvent(e);
+        e.type                   = reporterEvent::testCaseEnd;
+        e.testCaseStats.m_failed = true;
+        reportEvent(e);
+
+        p->capturedEvents = 0;
+        return events;
+    }
+
+    // sends the next test (if any) to an idle worker process - it is forked first if it isn't
+    // running (so no process is forked without a test for it) - returns false if nothing was sent
+    bool sendNextTask(ContextState* p, const Vector<const TestData*>& tests,
+                      Vector<WorkerProcess>& workers, unsigned which, Scheduler& scheduler,
+                      const OrderedResults& results) {
+        WorkerProcess& w = workers[which];
+        ProcessTask    task;
+        if(results.aborted || !scheduler.next(which, task.index))
+            return false;
+        if(w.pid == -1 && !startWorkerProcess(p, tests, workers, which)) {
+            scheduler.giveBack(which, task.index);
+            return false;
+        }
+        task.numFailedAssertions = results.numFailedAssertions;
+        if(!writeAll(w.taskFd, &task, sizeof(task))) {
+            scheduler.giveBack(which, task.index);
+            return false;
+        }
+        double timeout = getTimeout(p, *tests[task.index]);
+        w.current      = static_cast<int>(task.index);
+        w.deadline     = timeout > 0 ? getCurrentTime() + timeout + workerKillDelay : 0;
+        return true;
+    }
+
+    // executes the tests with a pool of forked processes - the output is the same as when serial
+    void runTestsInProcesses(ContextState* p, const Vector<const TestData*>& tests,
+                             const Vector<double>& estimates, OrderedResults& results) {
+        // a worker dying while the parent writes to it shouldn't kill the parent
+        void (*oldSigpipe)(int) = signal(SIGPIPE, SIG_IGN);
+
+        // with --dt-isolate=fork each test is executed by a new worker process
+        bool     isolate    = isolatesTests(p);
+        unsigned numWorkers = my_min(static_cast<unsigned>(my_max(p->workers, 1)), tests.size());
+        Vector<WorkerProcess> workers(numWorkers);
+        Vector<pollfd>        fds;
+        Scheduler             scheduler(estimates, numWorkers);
+
+        for(unsigned i = 0; i < numWorkers; ++i)
+            sendNextTask(p, tests, workers, i, scheduler, results);
+
+        for(;;) {
+            // gather the busy workers - and wait at most until the first of them is to be killed
+            fds.clear();
+            int    waitMs = -1;
+            double now    = getCurrentTime();
+            for(unsigned i = 0; i < numWorkers; ++i) {
+                if(workers[i].current != -1) {
+                    pollfd pfd = {workers[i].resultFd, POLLIN, 0};
+                    fds.push_back(pfd);
+                }
+                if(workers[i].current != -1 && workers[i].deadline > 0) {
+                    int ms = my_max(static_cast<int>((workers[i].deadline - now) * 1000) + 1, 0);
+                    waitMs = waitMs == -1 ? ms : my_min(waitMs, ms);
+                }
+            }
+            if(fds.size() == 0)
+                break;
+
+            if(poll(fds.data(), fds.size(), waitMs) < 0) {
+                if(errno == EINTR)
+                    continue;
+                break;
+            }
+
+            for(unsigned i = 0; i < numWorkers; ++i) {
+                WorkerProcess& w = workers[i];
+                if(w.current == -1)
+                    continue;
+                // find the poll result for this worker
+                short revents = 0;
+                for(unsigned k = 0; k < fds.size(); ++k)
+                    if(fds[k].fd == w.resultFd)
+                        revents = fds[k].revents;
+
+                // a worker which hasn't reported its test by the deadline is killed
+                bool killed = revents == 0 && w.deadline > 0 && getCurrentTime() >= w.deadline;
+                if(revents == 0 && !killed)
+                    continue;
+                if(killed)
+                    kill(w.pid, SIGKILL);
+
+                ProcessResult res;
+                Vector<char>  events;
+                bool          ok = !killed && readAll(w.resultFd, &res, sizeof(res));
+                if(ok) {
+                    events.resize(res.eventsSize);
+                    ok = readAll(w.resultFd, events.data(), res.eventsSize);
+                }
+
+                // a worker which crashed (after sending the events of the test) or died is gone
+                // - and one is retired after each test with --dt-isolate=fork
+                int status = 0;
+                if(!ok || res.crashed || isolate) {
+                    closeWorkerPipes(w);
+                    waitpid(w.pid, &status, 0);
+                    w.pid = -1;
+                }
+
+                if(ok) {
+                    results.add(res.index, res.failed != 0, events, res.numAssertions,
+                                res.numFailedAssertions, res.duration, p->abort_after);
+                } else {
+                    // the worker died - the test it was executing is failed
+                    unsigned index = static_cast<unsigned>(w.current);
+                    char     reason[DOCTEST_SNPRINTF_BUFFER_LENGTH];
+                    if(killed)
+                        DOCTEST_SNPRINTF(reason, DOCTEST_COUNTOF(reason),
+                                         "time limit of %gs exceeded - the worker process was "
+                                         "killed",
+                                         getTimeout(p, *tests[index]));
+                    else if(WIFEXITED(status))
+                        DOCTEST_SNPRINTF(reason, DOCTEST_COUNTOF(reason),
+                                         "worker process exited with code %d",
+                                         WEXITSTATUS(status));
+                    else if(WIFSIGNALED(status))
+                        DOCTEST_SNPRINTF(reason, DOCTEST_COUNTOF(reason),
+                                         "worker process was killed by signal %d",
+                                         WTERMSIG(status));
+                    else
+                        DOCTEST_SNPRINTF(reason, DOCTEST_COUNTOF(reason), "worker process died");
+                    results.add(index, true, getWorkerDiedEvents(p, *tests[index], reason), 0, 0,
+                                0.0, p->abort_after);
+                }
+                w.current = -1;
+                results.reportFinished(*p->reporters);
+
+                // a new worker is forked for the next test if this one is gone
+                sendNextTask(p, tests, workers, i, scheduler, results);
+            }
+        }
+
+        // closing the pipes makes the workers exit
+        for(unsigned i = 0; i < numWorkers; ++i) {
+            closeWorkerPipes(workers[i]);
+            if(workers[i].pid > 0)
+                waitpid(workers[i].pid, 0, 0);
+        }
+
+        // if all workers failed to start or died - the rest of the tests are executed here
+        runRemainingTests(p, tests, results);
+
+        signal(SIGPIPE, oldSigpipe);
+    }
+#endif // DOCTEST_PLATFORM_WINDOWS
+
+    // the signals on which the test which crashed is reported and the output is flushed before
+    // the program dies
+#ifdef DOCTEST_PLATFORM_WINDOWS
+    const int crashSignals[] = {SIGSEGV, SIGFPE, SIGILL, SIGABRT};
+#else  // DOCTEST_PLATFORM_WINDOWS
+    const int crashSignals[] = {SIGSEGV, SIGFPE, SIGILL, SIGABRT, SIGBUS};
+#endif // DOCTEST_PLATFORM_WINDOWS
+
+    // a test which runs over its time limit is interrupted with this signal by the watchdog - on
+    // Windows the watchdog raises it itself (after suspending the thread of the test)
+#ifdef DOCTEST_PLATFORM_WINDOWS
+    const int timeoutSignal = SIGTERM;
+#else  // DOCTEST_PLATFORM_WINDOWS
+    const int timeoutSignal = SIGALRM;
+#endif // DOCTEST_PLATFORM_WINDOWS
+
+    const char* getSignalName(int sig) {
+        switch(sig) {
+            case SIGSEGV: return "SIGSEGV - segmentation violation";
+            case SIGFPE: return "SIGFPE - floating point error";
+            case SIGILL: return "SIGILL - illegal instruction";
+            case SIGABRT: return "SIGABRT - abort";
+#ifndef DOCTEST_PLATFORM_WINDOWS
+            case SIGBUS: return "SIGBUS - bus error";
+#endif // DOCTEST_PLATFORM_WINDOWS
+            default: return "unknown signal";
+        }
+    }
+
+    // reports the test which crashed (with the signal and the last assert reached) and ends the
+    // run for the reporters - the reporters already know the subcases entered by the test. A
+    // worker process of --dt-workers sends the events to the parent instead (which goes on with
+    // the next test) and a worker thread of --dt-jobs reports the events it has captured for the
+    // test - the totals of the run are known only when executing serially
+    void reportCrash(ContextState* p, int sig) {
+        static char what[64];
+        static char reason[DOCTEST_SNPRINTF_BUFFER_LENGTH];
+        if(sig == timeoutSignal)
+            DOCTEST_SNPRINTF(what, DOCTEST_COUNTOF(what), "time limit of %gs exceeded",
+                             p->currentTestTimeout);
         else
-            DOCTEST_SNPRINTF(msg, DOCTEST_COUNTOF(msg), " FAILED! %s\n",
-                             (threw ? "(threw exception)" : ""));
+            DOCTEST_SNPRINTF(what, DOCTEST_COUNTOF(what), "%s", getSignalName(sig));
+        if(p->lastAssertFile)
+            DOCTEST_SNPRINTF(reason, DOCTEST_COUNTOF(reason),
+                             "%s - the last assert reached: %s(%d)", what,
+                             fileForOutput(p->lastAssertFile), p->lastAssertLine);
+        else
+            DOCTEST_SNPRINTF(reason, DOCTEST_COUNTOF(reason), "%s", what);
+
+#ifdef DOCTEST_PLATFORM_WINDOWS
+        bool isWorkerProcess = false;
+#else  // DOCTEST_PLATFORM_WINDOWS
+        SubcaseProcessState& subcaseProcess  = getSubcaseProcessState();
+        bool                 isWorkerProcess =
+                getWorkerProcessState().resultFd != -1 || subcaseProcess.messageFd != -1;
+#endif // DOCTEST_PLATFORM_WINDOWS
+        Vector<char>* captured = p->capturedEvents;
+        if(captured && !isWorkerProcess) {
+            p->capturedEvents = 0;
+            replayEvents(*p->reporters, *captured);
+        }
+
+        ReporterEvent e = makeEvent(reporterEvent::testCaseCrashed);
+        e.testCase      = getTestCaseData(*p->currentTest);
+        e.reason        = reason;
+        reportEvent(e);
+#ifndef DOCTEST_PLATFORM_WINDOWS
+        // a process of --dt-fork-subcases leaves the end of the test to the one executing it
+        if(subcaseProcess.messageFd != -1) {
+            sendSubcaseMessage(p, subcaseMessage::crashed, 1);
+            return;
+        }
+#endif // DOCTEST_PLATFORM_WINDOWS
+        e.type                                = reporterEvent::testCaseEnd;
+        e.testCaseStats.m_failed              = true;
+        e.testCaseStats.m_numAssertions       = p->numAssertionsForCurrentTestcase;
+        e.testCaseStats.m_numFailedAssertions = p->numFailedAssertionsForCurrentTestcase;
+        for(unsigned i = 0; i < perfCounter::count; ++i)
+            e.testCaseStats.m_perfCounters[i] = -1;
+        reportEvent(e);
+
+#ifndef DOCTEST_PLATFORM_WINDOWS
+        if(sendCrashedTest(p))
+            return;
+#endif // DOCTEST_PLATFORM_WINDOWS
+        if(captured)
+            return;
+
+        e                                = makeEvent(reporterEvent::runEnd);
+        e.runStats.m_numTestCases        = p->numTestCasesExecuted;
+        e.runStats.m_numFailedTestCases  = p->numFailedTestCases + 1;
+        e.runStats.m_numAssertions       = p->numAssertions + p->numAssertionsForCurrentTestcase;
+        e.runStats.m_numFailedAssertions = p->numFailedAssertions;
+        reportEvent(e);
+    }
+
+    void handleCrash(int sig) {
+        // a crash while handling a crash (or in another thread at the same time) isn't reported
+        static volatile sig_atomic_t isHandling = 0;
+        ContextState*                p          = getContextState();
+        // a test which was late but has ended before the signal got to it isn't interrupted
+        if(sig == timeoutSignal && (isHandling || !p || !p->currentTest))
+            return;
+        if(!isHandling && p && p->currentTest && p->reporters) {
+            isHandling = 1;
+            reportCrash(p, sig);
+        }
+
+        // give the thread of --dt-async-reporters some time to process what has been reported (it
+        // isn't waited for with a Signal since that isn't safe in a signal handler)
+        for(int i = 0; i < 10000 && p && p->reporters && p->reporters->ring; ++i) {
+            if(p->reporters->ring->empty())
+                break;
+            sleepBriefly();
+        }
+        // the output of the junit reporter (if writing to a file) too
+        flushOutput(false);
+        fflush(0);
+        signal(sig, SIG_DFL);
+        raise(sig);
+    }
+
+#ifndef DOCTEST_PLATFORM_WINDOWS
+    // the size of the alternate stack on which the crash handler runs
+    const size_t crashStackSize = 64 * 1024;
+
+    // an alternate stack for the signal handlers of the calling thread (each thread needs its own)
+    // - so even a stack overflow can be reported
+    class AlternateStack
+    {
+        char*   m_stack;
+        stack_t m_previous;
+
+        AlternateStack(const AlternateStack&);
+        AlternateStack& operator=(const AlternateStack&);
+
+    public:
+        AlternateStack()
+                : m_stack(static_cast<char*>(malloc(crashStackSize))) {
+            stack_t stack;
+            stack.ss_sp    = m_stack;
+            stack.ss_size  = crashStackSize;
+            stack.ss_flags = 0;
+            if(m_stack && sigaltstack(&stack, &m_previous) != 0) {
+                free(m_stack);
+                m_stack = 0;
+            }
+        }
+        ~AlternateStack() {
+            if(!m_stack)
+                return;
+            sigaltstack(&m_previous, 0);
+            free(m_stack);
+        }
+    };
+#endif // DOCTEST_PLATFORM_WINDOWS
+
+    // installs handleCrash() for the duration of a run and restores the previous handlers
+    class CrashHandler
+    {
+#ifdef DOCTEST_PLATFORM_WINDOWS
+        typedef void (*handlerType)(int);
+        handlerType m_previous[DOCTEST_COUNTOF(crashSignals)];
+#else  // DOCTEST_PLATFORM_WINDOWS
+        AlternateStack   m_stack;
+        struct sigaction m_previous[DOCTEST_COUNTOF(crashSignals)];
+#endif // DOCTEST_PLATFORM_WINDOWS
+
+        CrashHandler(const CrashHandler&);
+        CrashHandler& operator=(const CrashHandler&);
+
+    public:
+        CrashHandler() {
+#ifdef DOCTEST_PLATFORM_WINDOWS
+            for(unsigned i = 0; i < DOCTEST_COUNTOF(crashSignals); ++i)
+                m_previous[i] = signal(crashSignals[i], handleCrash);
+#else  // DOCTEST_PLATFORM_WINDOWS
+            struct sigaction action;
+            memset(&action, 0, sizeof(action));
+            action.sa_handler = handleCrash;
+            action.sa_flags   = SA_ONSTACK;
+            sigemptyset(&action.sa_mask);
+            for(unsigned i = 0; i < DOCTEST_COUNTOF(crashSignals); ++i)
+                sigaction(crashSignals[i], &action, &m_previous[i]);
+#endif // DOCTEST_PLATFORM_WINDOWS
+        }
+        ~CrashHandler() {
+            for(unsigned i = 0; i < DOCTEST_COUNTOF(crashSignals); ++i)
+#ifdef DOCTEST_PLATFORM_WINDOWS
+                signal(crashSignals[i], m_previous[i]);
+#else  // DOCTEST_PLATFORM_WINDOWS
+                sigaction(crashSignals[i], &m_previous[i], 0);
+#endif // DOCTEST_PLATFORM_WINDOWS
+            flushOutput(true);
+        }
+    };
+
+#ifndef DOCTEST_PLATFORM_WINDOWS
+    // installs handleCrash() for the signal with which the watchdog interrupts a test which is late
+    class TimeoutHandler
+    {
+        struct sigaction m_previous;
+
+        TimeoutHandler(const TimeoutHandler&);
+        TimeoutHandler& operator=(const TimeoutHandler&);
+
+    public:
+        TimeoutHandler() {
+            struct sigaction action;
+            memset(&action, 0, sizeof(action));
+            action.sa_handler = handleCrash;
+            action.sa_flags   = SA_ONSTACK;
+            sigemptyset(&action.sa_mask);
+            sigaction(timeoutSignal, &action, &m_previous);
+        }
+        ~TimeoutHandler() { sigaction(timeoutSignal, &m_previous, 0); }
+    };
+#endif // DOCTEST_PLATFORM_WINDOWS
+
+#ifndef DOCTEST_CONFIG_NO_MULTITHREADING
+    // a minimal portable thread - started with a function and an argument for it
+    class Thread
+    {
+    public:
+        typedef void (*entryType)(void*);
+
+    private:
+        entryType m_entry;
+        void*     m_arg;
+#ifdef DOCTEST_PLATFORM_WINDOWS
+        HANDLE m_handle;
+
+        static DWORD WINAPI trampoline(LPVOID self) {
+            static_cast<Thread*>(self)->m_entry(static_cast<Thread*>(self)->m_arg);
+            return 0;
+        }
+#else  // DOCTEST_PLATFORM_WINDOWS
+        pthread_t m_handle;
+
+        static void* trampoline(void* self) {
+            static_cast<Thread*>(self)->m_entry(static_cast<Thread*>(self)->m_arg);
+            return 0;
+        }
+#endif // DOCTEST_PLATFORM_WINDOWS
+
+        bool m_started;
+
+    public:
+        Thread()
+                : m_entry(0)
+                , m_arg(0)
+                , m_handle()
+                , m_started(false) {}
+
+        bool start(entryType entry, void* arg) {
+            m_entry = entry;
+            m_arg   = arg;
+#ifdef DOCTEST_PLATFORM_WINDOWS
+            m_handle  = CreateThread(0, 0, trampoline, this, 0, 0);
+            m_started = m_handle != 0;
+#else  // DOCTEST_PLATFORM_WINDOWS
+            m_started = pthread_create(&m_handle, 0, trampoline, this) == 0;
+#endif // DOCTEST_PLATFORM_WINDOWS
+            return m_started;
+        }
+
+        void join() {
+            if(!m_started)
+                return;
+#ifdef DOCTEST_PLATFORM_WINDOWS
+            WaitForSingleObject(m_handle, INFINITE);
+            CloseHandle(m_handle);
+#else  // DOCTEST_PLATFORM_WINDOWS
+            pthread_join(m_handle, 0);
+#endif // DOCTEST_PLATFORM_WINDOWS
+            m_started = false;
+        }
+    };
+
+    // interrupts the tests which run over their time limit (--dt-timeout) - a thread checks the
+    // deadlines of the tests being executed by the threads of the process and signals the thread
+    // of a test which is late so the test is reported by handleCrash() like one which crashed
+    class Watchdog
+    {
+        // a thread which executes tests
+        struct Watched
+        {
+            ContextState* state;    // of the thread
+            double        deadline; // of the test being executed - 0 if it has no time limit
+#ifdef DOCTEST_PLATFORM_WINDOWS
+            DWORD thread;
+#else  // DOCTEST_PLATFORM_WINDOWS
+            pthread_t thread;
+#endif // DOCTEST_PLATFORM_WINDOWS
+        };
+
+#ifndef DOCTEST_PLATFORM_WINDOWS
+        TimeoutHandler m_handler;
+#endif // DOCTEST_PLATFORM_WINDOWS
+
+        Mutex           m_mutex;   // guards everything below
+        Vector<Watched> m_watched; // the threads which have executed tests so far
+        bool            m_stopped;
+        Thread          m_thread;
+
+        Watchdog(const Watchdog&);
+        Watchdog& operator=(const Watchdog&);
+
+        static void interrupt(const Watched& w) {
+#ifdef DOCTEST_PLATFORM_WINDOWS
+            // there are no signals for threads - the test is reported from this thread with the
+            // state of the thread of the test (which is stopped) and the program ends there
+            HANDLE thread = OpenThread(THREAD_SUSPEND_RESUME, FALSE, w.thread);
+            if(thread) {
+                SuspendThread(thread);
+                CloseHandle(thread);
+            }
+            getContextState() = w.state;
+            handleCrash(timeoutSignal);
+#else  // DOCTEST_PLATFORM_WINDOWS
+            pthread_kill(w.thread, timeoutSignal);
+#endif // DOCTEST_PLATFORM_WINDOWS
+        }
+
+        static void watch(void* in) {
+            Watchdog& self = *static_cast<Watchdog*>(in);
+            for(;;) {
+                {
+                    MutexLock lock(self.m_mutex);
+                    if(self.m_stopped)
+                        break;
+                    double now = getCurrentTime();
+                    for(unsigned i = 0; i < self.m_watched.size(); ++i) {
+                        Watched& w = self.m_watched[i];
+                        if(w.deadline > 0 && now >= w.deadline) {
+                            w.deadline = 0;
+                            interrupt(w);
+                        }
+                    }
+                }
+                sleepMilliseconds(10);
+            }
+        }
+
+    public:
+        Watchdog()
+                : m_stopped(false) {
+            m_thread.start(watch, this);
+        }
+        ~Watchdog() {
+            {
+                MutexLock lock(m_mutex);
+                m_stopped = true;
+            }
+            m_thread.join();
+        }
+
+        // the thread with the state 'p' starts a test with this time limit (0 for none)
+        void start(ContextState* p, double timeout) {
+            MutexLock lock(m_mutex);
+            unsigned  i = 0;
+            while(i < m_watched.size() && m_watched[i].state != p)
+                ++i;
+            if(i == m_watched.size()) {
+                Watched added = Watched();
+                added.state   = p;
+                m_watched.push_back(added);
+            }
+#ifdef DOCTEST_PLATFORM_WINDOWS
+            m_watched[i].thread = GetCurrentThreadId();
+#else  // DOCTEST_PLATFORM_WINDOWS
+            m_watched[i].thread = pthread_self();
+#endif // DOCTEST_PLATFORM_WINDOWS
+            m_watched[i].deadline = timeout > 0 ? getCurrentTime() + timeout : 0;
+        }
+
+        // the thread with the state 'p' has ended its test
+        void stop(ContextState* p) {
+            MutexLock lock(m_mutex);
+            for(unsigned i = 0; i < m_watched.size(); ++i)
+                if(m_watched[i].state == p)
+                    m_watched[i].deadline = 0;
+        }
+    };
+
+    // with --dt-parallel-subcases each run of a test function (one for each path through its
+    // subcases) is a separate work item. The first run of a test enters the first subcase on each
+    // level as usual and each subcase it skips becomes a run of its own - entering the subcases
+    // on the path to it and then again the first subcase on each level inside of it (and so on)
+    struct SubcaseRun
+    {
+        unsigned            test; // the index of the test
+        Vector<SubcaseStep> path; // the path to the subcase it starts from
+    };
+
+    // what a run of --dt-parallel-subcases has reported - the runs of a test are reported together
+    // (ordered by their paths - as when serial) once all of them are finished
+    struct FinishedSubcaseRun
+    {
+        Vector<unsigned> order;  // the ordinals of the subcases it entered - the outermost first
+        Vector<char>     events; // starting with the one for the start of the test
+        TestCaseStats    stats;
+    };
 
-        char info1[DOCTEST_SNPRINTF_BUFFER_LENGTH];
-        DOCTEST_SNPRINTF(info1, DOCTEST_COUNTOF(info1), "  %s( %s )\n", assert_name, expr);
+    struct SplitTest
+    {
+        unsigned                   numPending; // the runs which haven't finished yet
+        Vector<FinishedSubcaseRun> runs;
+        bool                       hasLast; // if a run has skipped none of the subcases
+        Vector<unsigned>           last;    // the order of the first such run - none after it
+
+        SplitTest()
+                : numPending(0)
+                , hasLast(false) {}
+    };
 
-        char info2[DOCTEST_SNPRINTF_BUFFER_LENGTH];
-        char info3[DOCTEST_SNPRINTF_BUFFER_LENGTH];
-        info2[0] = 0;
-        info3[0] = 0;
-        if(!threw) {
-            DOCTEST_SNPRINTF(info2, DOCTEST_COUNTOF(info2), "with expansion:\n");
-            DOCTEST_SNPRINTF(info3, DOCTEST_COUNTOF(info3), "  %s( %s )\n", assert_name,
-                             decomposition);
-        }
+    // the state shared between the worker threads of a multithreaded run (--dt-jobs)
+    struct ParallelRun
+    {
+        const ContextState*            options; // each worker starts from a copy of this
+        const Vector<const TestData*>* tests;   // the tests to be executed
+
+        Scheduler scheduler; // hands out the tests to the workers - has a lock for each queue
+
+        Mutex          mutex;   // guards everything below
+        OrderedResults results; // the results and captured events of the tests
+
+        // for --dt-parallel-subcases
+        Vector<SubcaseRun> subcaseRuns; // the runs left for later (of tests which have started)
+        Vector<SplitTest>  splitTests;  // for each test
+        unsigned           numRunning;  // the runs being executed - they may leave more for later
+
+        ParallelRun(const ContextState* in_options, const Vector<const TestData*>* in_tests,
+                    const Vector<double>& estimates, unsigned numThreads)
+                : options(in_options)
+                , tests(in_tests)
+                , scheduler(estimates, numThreads)
+                , results(in_tests->size())
+                , splitTests(in_options->parallel_subcases ? in_tests->size() : 0)
+                , numRunning(0) {}
+    };
 
-        DOCTEST_PRINTF_COLORED(loc, Color::LightGrey);
-        DOCTEST_PRINTF_COLORED(msg, passed ? Color::BrightGreen : Color::Red);
-        DOCTEST_PRINTF_COLORED(info1, Color::Green);
-        DOCTEST_PRINTF_COLORED(info2, Color::None);
-        DOCTEST_PRINTF_COLORED(info3, Color::Green);
-        DOCTEST_PRINTF_COLORED("\n", Color::None);
+    // what each worker thread gets - the shared state and its own id for the scheduler
+    struct ParallelWorkerArgs
+    {
+        ParallelRun* run;
+        unsigned     id;
+    };
 
-        printToDebugConsole(String(loc) + msg + info1 + info2 + info3 + "\n");
+    // executes a single run of a test for --dt-parallel-subcases - along the path in the state
+    void executeSubcaseRun(ContextState* p, const TestData& data, FinishedSubcaseRun& res) {
+        p->currentTest = &data;
+        p->setLastAssert(0, 0);
+        watchTest(p, data);
+
+        ReporterEvent e = makeEvent(reporterEvent::testCaseStart);
+        e.testCase      = getTestCaseData(data);
+        reportEvent(e);
+
+        double start      = getCurrentTime();
+        bool   measureCpu = p->durations;
+        double cpuStart   = measureCpu ? getCurrentCpuTime() : 0;
+        p->numAssertionsForCurrentTestcase       = 0;
+        p->numFailedAssertionsForCurrentTestcase = 0;
+        resetSubcaseTree(p, data);
+        startSubcaseRun(p);
+
+        PerfCounters counters;
+        startPerfCounters(counters, p->perfCounters);
+        startAllocationTracking();
+        int failed = callTestFunc(data.m_f);
+        stopAllocationTracking(res.stats);
+        stopPerfCounters(counters);
+
+        res.stats.m_failed              = failed != 0;
+        res.stats.m_numAssertions       = p->numAssertionsForCurrentTestcase;
+        res.stats.m_numFailedAssertions = p->numFailedAssertionsForCurrentTestcase;
+        res.stats.m_duration            = getCurrentTime() - start;
+        res.stats.m_cpuDuration         = measureCpu ? getCurrentCpuTime() - cpuStart : 0;
+        memcpy(res.stats.m_perfCounters, counters.values, sizeof(counters.values));
+
+        const Vector<SubcaseNode>& tree = p->subcaseTree;
+        res.order.resize(tree[p->subcasesLastEntered].depth);
+        for(unsigned i = p->subcasesLastEntered; i != 0; i = tree[i].parent)
+            res.order[tree[i].depth - 1] = tree[i].ordinal;
+
+        unwatchTest(p);
+        p->currentTest = 0; // for the crash handler
     }
 
-    void logAssertThrows(bool threw, const char* expr, const char* assert_name, const char* file,
-                         int line) {
-        char loc[DOCTEST_SNPRINTF_BUFFER_LENGTH];
-        DOCTEST_SNPRINTF(loc, DOCTEST_COUNTOF(loc), "%s(%d)", fileForOutput(file), line);
+    // if the subcases entered by a run of --dt-parallel-subcases come before those of another one
+    bool isSubcaseOrderBefore(const Vector<unsigned>& lhs, const Vector<unsigned>& rhs) {
+        for(unsigned i = 0; i < lhs.size() && i < rhs.size(); ++i)
+            if(lhs[i] != rhs[i])
+                return lhs[i] < rhs[i];
+        return lhs.size() < rhs.size();
+    }
 
-        char msg[DOCTEST_SNPRINTF_BUFFER_LENGTH];
-        if(threw)
-            DOCTEST_SNPRINTF(msg, DOCTEST_COUNTOF(msg), " PASSED!\n");
-        else
-            DOCTEST_SNPRINTF(msg, DOCTEST_COUNTOF(msg), " FAILED!\n");
+    // the ordinals of the subcases on the path of a run which hasn't been executed yet
+    Vector<unsigned> getSubcaseOrder(const Vector<SubcaseStep>& path) {
+        Vector<unsigned> order(path.size());
+        for(unsigned i = 0; i < path.size(); ++i)
+            order[i] = path[i].ordinal;
+        return order;
+    }
 
-        char info1[DOCTEST_SNPRINTF_BUFFER_LENGTH];
-        DOCTEST_SNPRINTF(info1, DOCTEST_COUNTOF(info1), "  %s( %s )\n\n", assert_name, expr);
+    // reports the runs of a test of --dt-parallel-subcases as a single test (as runTestCase()
+    // would) - called under the lock of the run when all of them are finished
+    void finishSplitTest(ParallelRun& run, unsigned index) {
+        const SplitTest&                  test = run.splitTests[index];
+        const Vector<FinishedSubcaseRun>& runs = test.runs;
+
+        // in the order of their paths - insertion sort since there are usually just a few of them
+        Vector<unsigned> order;
+        for(unsigned i = 0; i < runs.size(); ++i) {
+            // finished before a run which comes before it has ended the test
+            if(test.hasLast && isSubcaseOrderBefore(test.last, runs[i].order))
+                continue;
+            order.push_back(i);
+            for(unsigned k = order.size() - 1; k > 0; --k) {
+                if(!isSubcaseOrderBefore(runs[order[k]].order, runs[order[k - 1]].order))
+                    break;
+                unsigned temp = order[k];
+                order[k]      = order[k - 1];
+                order[k - 1]  = temp;
+            }
+        }
 
-        DOCTEST_PRINTF_COLORED(loc, Color::LightGrey);
-        DOCTEST_PRINTF_COLORED(msg, threw ? Color::BrightGreen : Color::Red);
-        DOCTEST_PRINTF_COLORED(info1, Color::Green);
+        ContextState* p        = getContextState();
+        Vector<char>* captured = p->capturedEvents;
+        Vector<char>  events;
+        p->capturedEvents = &events;
+
+        ReporterEvent e = makeEvent(reporterEvent::testCaseEnd);
+        e.testCase      = getTestCaseData(*(*run.tests)[index]);
+        TestCaseStats total;
+        memset(&total, 0, sizeof(total));
+        for(unsigned i = 0; i < perfCounter::count; ++i)
+            total.m_perfCounters[i] = -1;
+        for(unsigned i = 0; i < order.size(); ++i) {
+            const FinishedSubcaseRun& r = runs[order[i]];
+
+            // the start of the test is reported only once - the next runs reenter it
+            unsigned skip = 0;
+            if(i > 0) {
+                skip            = readRecord(r.events.data()).size;
+                e.type          = reporterEvent::testCaseIterationEnd;
+                e.testCaseStats = runs[order[i - 1]].stats;
+                reportEvent(e);
+                e.type = reporterEvent::testCaseReenter;
+                reportEvent(e);
+            }
+            for(unsigned k = skip; k < r.events.size(); ++k)
+                events.push_back(r.events[k]);
+
+            total.m_failed = total.m_failed || r.stats.m_failed;
+            total.m_numAssertions += r.stats.m_numAssertions;
+            total.m_numFailedAssertions += r.stats.m_numFailedAssertions;
+            total.m_duration += r.stats.m_duration;
+            total.m_cpuDuration += r.stats.m_cpuDuration;
+            total.m_numAllocations += r.stats.m_numAllocations;
+            total.m_allocatedBytes += r.stats.m_allocatedBytes;
+            total.m_peakAllocatedBytes =
+                    my_max(total.m_peakAllocatedBytes, r.stats.m_peakAllocatedBytes);
+            for(unsigned k = 0; k < perfCounter::count; ++k)
+                if(r.stats.m_perfCounters[k] >= 0)
+                    total.m_perfCounters[k] =
+                            my_max(total.m_perfCounters[k], 0.0) + r.stats.m_perfCounters[k];
+        }
+        if(order.size() > 1) {
+            e.type          = reporterEvent::testCaseIterationEnd;
+            e.testCaseStats = runs[order[order.size() - 1]].stats;
+            reportEvent(e);
+        }
+        e.type          = reporterEvent::testCaseEnd;
+        e.testCaseStats = total;
+        reportEvent(e);
 
-        printToDebugConsole(String(loc) + msg + info1);
+        p->capturedEvents = captured;
+        run.results.add(index, total.m_failed, events, total.m_numAssertions,
+                        total.m_numFailedAssertions, total.m_duration, p->abort_after);
     }
 
-    void logAssertThrowsAs(bool threw, bool threw_as, const char* as, const char* expr,
-                           const char* assert_name, const char* file, int line) {
-        char loc[DOCTEST_SNPRINTF_BUFFER_LENGTH];
-        DOCTEST_SNPRINTF(loc, DOCTEST_COUNTOF(loc), "%s(%d)", fileForOutput(file), line);
-
-        char msg[DOCTEST_SNPRINTF_BUFFER_LENGTH];
-        if(threw_as)
-            DOCTEST_SNPRINTF(msg, DOCTEST_COUNTOF(msg), " PASSED!\n");
-        else
-            DOCTEST_SNPRINTF(msg, DOCTEST_COUNTOF(msg), " FAILED! %s\n",
-                             (threw ? "(threw something else)" : "(didn't throw at all)"));
+    // executes a run of --dt-parallel-subcases by a worker thread of --dt-jobs - the subcases it
+    // skips are left for later as runs of their own
+    void executeSplitRun(ParallelRun& run, ContextState& state, const SubcaseRun& item) {
+        Vector<Vector<SubcaseStep> > spawned;
+        FinishedSubcaseRun           res;
+        Vector<char>*                captured = state.capturedEvents;
+        state.subcasesPath                    = item.path;
+        state.subcasesSpawned                 = &spawned;
+        state.capturedEvents                  = &res.events;
+        executeSubcaseRun(&state, *(*run.tests)[item.test], res);
+        state.capturedEvents  = captured;
+        state.subcasesSpawned = 0;
+        state.subcasesPath.clear();
+
+        // same as when serial - no more runs after enough assertions have failed
+        if(state.abort_after > 0 && state.numFailedAssertions >= state.abort_after)
+            spawned.clear();
+
+        MutexLock  lock(run.mutex);
+        SplitTest& test = run.splitTests[item.test];
+        run.numRunning--;
+        if(test.hasLast && isSubcaseOrderBefore(test.last, res.order)) {
+            // serially it wouldn't have been executed - neither the runs it has left for later
+            spawned.clear();
+        } else {
+            if(!state.subcasesHasSkipped) {
+                // serially the test ends with it (when it throws or a REQUIRE fails before the
+                // subcases after it are reached) - so the runs after it are dropped
+                test.hasLast = true;
+                test.last    = res.order;
+                unsigned num = 0;
+                for(unsigned i = 0; i < run.subcaseRuns.size(); ++i) {
+                    const SubcaseRun& other = run.subcaseRuns[i];
+                    if(other.test == item.test &&
+                       isSubcaseOrderBefore(test.last, getSubcaseOrder(other.path)))
+                        test.numPending--;
+                    else
+                        run.subcaseRuns[num++] = other;
+                }
+                run.subcaseRuns.resize(num);
+            }
+            // in reverse - the first of them is taken first (as when serial)
+            for(unsigned i = spawned.size(); i > 0; --i) {
+                SubcaseRun next;
+                next.test = item.test;
+                next.path = spawned[i - 1];
+                run.subcaseRuns.push_back(next);
+            }
+            test.numPending += spawned.size();
+            test.runs.push_back(res);
+        }
+        if(--test.numPending == 0) {
+            finishSplitTest(run, item.test);
+            run.results.reportFinished(*state.reporters);
+        }
+    }
 
-        char info1[DOCTEST_SNPRINTF_BUFFER_LENGTH];
-        DOCTEST_SNPRINTF(info1, DOCTEST_COUNTOF(info1), "  %s( %s, %s )\n\n", assert_name, expr,
-                         as);
+    // the entry point of each worker thread of a multithreaded run (--dt-jobs)
+    void parallelWorker(void* in) {
+        ParallelRun& run = *static_cast<ParallelWorkerArgs*>(in)->run;
+        unsigned     id  = static_cast<ParallelWorkerArgs*>(in)->id;
 
-        DOCTEST_PRINTF_COLORED(loc, Color::LightGrey);
-        DOCTEST_PRINTF_COLORED(msg, threw_as ? Color::BrightGreen : Color::Red);
-        DOCTEST_PRINTF_COLORED(info1, Color::Green);
+#ifndef DOCTEST_PLATFORM_WINDOWS
+        // a crash of a test executed by this thread is handled on a stack of its own
+        AlternateStack stack;
+#endif // DOCTEST_PLATFORM_WINDOWS
 
-        printToDebugConsole(String(loc) + msg + info1);
-    }
+        // each worker owns its own copy of the options and of the runtime state - forking a
+        // process with more than one thread isn't safe so subcases are entered as usual
+        ContextState state(*run.options);
+        state.fork_subcases = false;
+        Vector<char> events;
+        state.capturedEvents = &events;
+        getContextState()    = &state;
+
+        for(;;) {
+            SubcaseRun item; // the test - with --dt-parallel-subcases also the path of the run
+            bool       queued = false;
+            {
+                MutexLock lock(run.mutex);
+                if(run.results.aborted)
+                    break;
+                // the runs left for later go first - so the tests they are a part of finish early
+                if(run.subcaseRuns.size() > 0) {
+                    item = run.subcaseRuns[run.subcaseRuns.size() - 1];
+                    run.subcaseRuns.pop_back();
+                    queued = true;
+                }
+            }
 
-    void logAssertNothrow(bool threw, const char* expr, const char* assert_name, const char* file,
-                          int line) {
-        char loc[DOCTEST_SNPRINTF_BUFFER_LENGTH];
-        DOCTEST_SNPRINTF(loc, DOCTEST_COUNTOF(loc), "%s(%d)", fileForOutput(file), line);
+            // the scheduler has a lock for each of its queues - it isn't called under the one of
+            // the run so the workers contend only when stealing from the same queue
+            bool scheduled = !queued && run.scheduler.next(id, item.test);
+            {
+                MutexLock lock(run.mutex);
+                if(!queued && !scheduled) {
+                    // the runs being executed may leave more for later
+                    if(run.numRunning == 0 && run.subcaseRuns.size() == 0)
+                        break;
+                } else if(run.options->parallel_subcases) {
+                    if(scheduled)
+                        run.splitTests[item.test].numPending = 1;
+                    run.numRunning++;
+                }
 
-        char msg[DOCTEST_SNPRINTF_BUFFER_LENGTH];
-        if(!threw)
-            DOCTEST_SNPRINTF(msg, DOCTEST_COUNTOF(msg), " PASSED!\n");
-        else
-            DOCTEST_SNPRINTF(msg, DOCTEST_COUNTOF(msg), " FAILED!\n");
+                // start from the global count so --dt-abort-after works across workers
+                state.numFailedAssertions = run.results.numFailedAssertions;
+            }
 
-        char info1[DOCTEST_SNPRINTF_BUFFER_LENGTH];
-        DOCTEST_SNPRINTF(info1, DOCTEST_COUNTOF(info1), "  %s( %s )\n\n", assert_name, expr);
+            if(!queued && !scheduled) {
+                sleepBriefly();
+                continue;
+            }
+            if(run.options->parallel_subcases) {
+                executeSplitRun(run, state, item);
+                continue;
+            }
 
-        DOCTEST_PRINTF_COLORED(loc, Color::LightGrey);
-        DOCTEST_PRINTF_COLORED(msg, !threw ? Color::BrightGreen : Color::Red);
-        DOCTEST_PRINTF_COLORED(info1, Color::Green);
+            unsigned index           = item.test;
+            int      numFailedBefore = state.numFailedAssertions;
+            double   start           = getCurrentTime();
+            bool     failed          = runTestCase(&state, *(*run.tests)[index]);
+            double   duration        = getCurrentTime() - start;
 
-        printToDebugConsole(String(loc) + msg + info1);
-    }
+            MutexLock lock(run.mutex);
+            run.results.add(index, failed, events, state.numAssertions,
+                            state.numFailedAssertions - numFailedBefore, duration,
+                            state.abort_after);
+            run.results.reportFinished(*state.reporters);
 
-    // the implementation of parseFlag()
-    bool parseFlagImpl(int argc, const char* const* argv, const char* pattern) {
-        for(int i = argc - 1; i >= 0; --i) {
-            const char* temp = strstr(argv[i], pattern);
-            if(temp && my_strlen(temp) == my_strlen(pattern)) {
-                // eliminate strings in which the chars before the option are not '-'
-                bool noBadCharsFound = true;
-                while(temp != argv[i]) {
-                    if(*--temp != '-') {
-                        noBadCharsFound = false;
-                        break;
-                    }
-                }
-                if(noBadCharsFound)
-                    return true;
-            }
+            events.clear();
+            state.numAssertions = 0;
         }
-        return false;
     }
 
-    // locates a flag on the command line
-    bool parseFlag(int argc, const char* const* argv, const char* pattern) {
-#ifndef DOCTEST_CONFIG_NO_UNPREFIXED_OPTIONS
-        if(!parseFlagImpl(argc, argv, pattern))
-            return parseFlagImpl(argc, argv, pattern + 3); // 3 for "dt-"
-        return true;
-#else  // DOCTEST_CONFIG_NO_UNPREFIXED_OPTIONS
-        return parseFlagImpl(argc, argv, pattern);
-#endif // DOCTEST_CONFIG_NO_UNPREFIXED_OPTIONS
+    // executes the tests with a pool of worker threads - the output is the same as when serial
+    void runTestsInParallel(ContextState* p, const Vector<const TestData*>& tests,
+                            const Vector<double>& estimates, OrderedResults& results) {
+        unsigned    numThreads = my_min(static_cast<unsigned>(p->jobs), tests.size());
+        ParallelRun run(p, &tests, estimates, numThreads);
+
+        Vector<Thread>             threads(numThreads);
+        Vector<ParallelWorkerArgs> args(numThreads);
+        for(unsigned i = 0; i < numThreads; ++i) {
+            args[i].run = &run;
+            args[i].id  = i;
+        }
+        // if a thread could not be created the others steal its tests
+        unsigned numStarted = 0;
+        for(unsigned i = 0; i < numThreads; ++i)
+            numStarted += threads[i].start(parallelWorker, &args[i]) ? 1 : 0;
+        if(numStarted == 0)
+            parallelWorker(&args[0]);
+        for(unsigned i = 0; i < numThreads; ++i)
+            threads[i].join();
+
+        // the tests of --dt-parallel-subcases with runs not executed because of --dt-abort-after
+        for(unsigned i = 0; i < run.splitTests.size(); ++i)
+            if(run.splitTests[i].numPending > 0 && run.splitTests[i].runs.size() > 0)
+                finishSplitTest(run, i);
+
+        results = run.results;
     }
 
-    // the implementation of parseOption()
-    bool parseOptionImpl(int argc, const char* const* argv, const char* pattern, String& res) {
-        for(int i = argc - 1; i >= 0; --i) {
-            const char* temp = strstr(argv[i], pattern);
-            if(temp) {
-                // eliminate matches in which the chars before the option are not '-'
-                bool        noBadCharsFound = true;
-                const char* curr            = argv[i];
-                while(curr != temp) {
-                    if(*curr++ != '-') {
-                        noBadCharsFound = false;
-                        break;
-                    }
-                }
-                if(noBadCharsFound) {
-                    temp += my_strlen(pattern);
-                    unsigned len = my_strlen(temp);
-                    if(len) {
-                        res = temp;
-                        return true;
-                    }
+    // feeds the reporters from a separate thread (--dt-async-reporters) - the thread executing the
+    // tests only copies the events into a ring buffer and doesn't wait for formatting and I/O
+    class AsyncReporting
+    {
+        Reporters&    m_reporters;
+        ContextState* m_state;
+        EventRing     m_ring;
+        Thread        m_thread;
+
+        AsyncReporting(const AsyncReporting&);
+        AsyncReporting& operator=(const AsyncReporting&);
+
+        static void consume(void* in) {
+            AsyncReporting& self = *static_cast<AsyncReporting*>(in);
+
+            // the reporters get to the options of the run through the state of the current thread
+            getContextState() = self.m_state;
+
+            for(;;) {
+                bool        finished = self.m_ring.finished();
+                const char* record   = self.m_ring.front();
+                if(record) {
+                    dispatchEvent(self.m_reporters.all, readRecord(record));
+                    self.m_ring.pop();
+                } else if(finished) {
+                    break;
+                } else {
+                    self.m_ring.waitForEvents();
                 }
             }
+            flushOutput(false);
         }
-        return false;
-    }
 
-    // parses an option and returns the string after the '=' character
-    bool parseOption(int argc, const char* const* argv, const char* pattern, String& res,
-                     const String& defaultVal = String()) {
-        res = defaultVal;
-#ifndef DOCTEST_CONFIG_NO_UNPREFIXED_OPTIONS
-        if(!parseOptionImpl(argc, argv, pattern, res))
-            return parseOptionImpl(argc, argv, pattern + 3, res); // 3 for "dt-"
-        return true;
-#else // DOCTEST_CONFIG_NO_UNPREFIXED_OPTIONS
-        return parseOptionImpl(argc, argv, pattern, res);
-#endif // DOCTEST_CONFIG_NO_UNPREFIXED_OPTIONS
-    }
+    public:
+        AsyncReporting(Reporters& reporters, ContextState* state)
+                : m_reporters(reporters)
+                , m_state(state)
+                , m_ring(DOCTEST_ASYNC_REPORTERS_BUFFER_LENGTH) {
+            // what has been printed so far should come before the output of the reporters
+            flushOutput(false);
+            if(m_thread.start(consume, this))
+                m_reporters.ring = &m_ring;
+        }
 
-    // parses a comma separated list of words after a pattern in one of the arguments in argv
-    bool parseCommaSepArgs(int argc, const char* const* argv, const char* pattern,
-                           Vector<String>& res) {
-        String filtersString;
-        if(parseOption(argc, argv, pattern, filtersString)) {
-            // tokenize with "," as a separator
-            char* pch = strtok(filtersString.c_str(), ","); // modifies the string
-            while(pch != 0) {
-                if(my_strlen(pch))
-                    res.push_back(pch);
-                pch = strtok(0, ","); // uses the strtok() internal state to go to the next token
-            }
-            return true;
+        // returns after everything reported so far has been processed
+        ~AsyncReporting() {
+            m_ring.finish();
+            m_thread.join();
+            m_reporters.ring = 0;
         }
-        return false;
+    };
+#else  // DOCTEST_CONFIG_NO_MULTITHREADING
+    void runTestsInParallel(ContextState* p, const Vector<const TestData*>& tests,
+                            const Vector<double>&, OrderedResults& results) {
+        runRemainingTests(p, tests, results);
     }
 
-    enum optionType
+    // without threads the reporters are always called directly
+    class AsyncReporting
     {
-        option_bool,
-        option_int
+    public:
+        AsyncReporting(Reporters&, ContextState*) {}
     };
 
-    // parses an int/bool option from the command line
-    bool parseIntOption(int argc, const char* const* argv, const char* pattern, optionType type,
-                        int& res) {
-        String parsedValue;
-        if(parseOption(argc, argv, pattern, parsedValue)) {
-            if(type == 0) {
-                // boolean
-                const char positive[][5] = {"1", "true", "on", "yes"};  // 5 - strlen("true") + 1
-                const char negative[][6] = {"0", "false", "off", "no"}; // 6 - strlen("false") + 1
-
-                // if the value matches any of the positive/negative possibilities
-                for(unsigned i = 0; i < 4; i++) {
-                    if(parsedValue.compare(positive[i], true) == 0) {
-                        res = 1;
-                        return true;
-                    }
-                    if(parsedValue.compare(negative[i], true) == 0) {
-                        res = 0;
-                        return true;
-                    }
-                }
-            } else {
-                // integer
-                int theInt = atoi(parsedValue.c_str());
-                if(theInt != 0) {
-                    res = theInt;
-                    return true;
-                }
-            }
+    // without threads the time limit of the test being executed is watched with a timer of the
+    // process (which isn't available on Windows) - there is only one test being executed anyway
+    class Watchdog
+    {
+#ifndef DOCTEST_PLATFORM_WINDOWS
+        TimeoutHandler m_handler;
+
+        static void setTimer(double seconds) {
+            itimerval timer;
+            memset(&timer, 0, sizeof(timer));
+            timer.it_value.tv_sec  = static_cast<time_t>(seconds);
+            timer.it_value.tv_usec = static_cast<suseconds_t>(
+                    (seconds - static_cast<double>(timer.it_value.tv_sec)) * 1000000);
+            setitimer(ITIMER_REAL, &timer, 0);
         }
-        return false;
-    }
 
-    void printVersion() {
-        DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
-        printf("doctest version is \"%s\"\n", DOCTEST_VERSION);
+    public:
+        void start(ContextState*, double timeout) { setTimer(timeout); }
+        void stop(ContextState*) { setTimer(0); }
+#else  // DOCTEST_PLATFORM_WINDOWS
+    public:
+        void start(ContextState*, double) {}
+        void stop(ContextState*) {}
+#endif // DOCTEST_PLATFORM_WINDOWS
+    };
+#endif // DOCTEST_CONFIG_NO_MULTITHREADING
+
+    // a watchdog is started only if any of the tests have a time limit
+    Watchdog* startWatchdog(const ContextState* p, const Vector<const TestData*>& tests) {
+        for(unsigned i = 0; i < tests.size(); ++i)
+            if(getTimeout(p, *tests[i]) > 0)
+                return new Watchdog;
+        return 0;
     }
 
-    void printHelp() {
-        printVersion();
-        DOCTEST_PRINTF_COLORED("[doctest]\n", Color::Cyan);
-        DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
-        printf("boolean values: \"1/on/yes/true\" or \"0/off/no/false\"\n");
-        DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
-        printf("filter  values: \"str1,str2,str3\" (comma separated strings)\n");
-        DOCTEST_PRINTF_COLORED("[doctest]\n", Color::Cyan);
-        DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
-        printf("filters use wildcards for matching strings\n");
-        DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
-        printf("something passes a filter if any of the strings in a filter matches\n");
-        DOCTEST_PRINTF_COLORED("[doctest]\n", Color::Cyan);
-        DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
-        printf("ALL FLAGS, OPTIONS AND FILTERS ALSO AVAILABLE WITH A \"dt-\" PREFIX!!!\n");
-        DOCTEST_PRINTF_COLORED("[doctest]\n", Color::Cyan);
-        DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
-        printf("Query flags - the program quits after them. Available:\n\n");
-        printf(" -?,   --help, -h                      prints this message\n");
-        printf(" -v,   --version                       prints the version\n");
-        printf(" -c,   --count                         prints the number of matching tests\n");
-        printf(" -ltc, --list-test-cases               lists all matching tests by name\n");
-        printf(" -lts, --list-test-suites              lists all matching test suites\n\n");
-        //printf(" -hth, --hash-table-histogram          undocumented\n");
-        // ==================================================================================== << 79
-        DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
-        printf("The available <int>/<string> options/filters are:\n\n");
-        printf(" -tc,  --test-case=<filters>           filters     tests by their name\n");
-        printf(" -tce, --test-case-exclude=<filters>   filters OUT tests by their name\n");
-        printf(" -sf,  --source-file=<filters>         filters     tests by their file\n");
-        printf(" -sfe, --source-file-exclude=<filters> filters OUT tests by their file\n");
-        printf(" -ts,  --test-suite=<filters>          filters     tests by their test suite\n");
-        printf(" -tse, --test-suite-exclude=<filters>  filters OUT tests by their test suite\n");
-        printf(" -ob,  --order-by=<string>             how the tests should be ordered\n");
-        printf("                                       <string> - by [file/suite/name/rand]\n");
-        printf(" -rs,  --rand-seed=<int>               seed for random ordering\n");
-        printf(" -f,   --first=<int>                   the first test passing the filters to\n");
-        printf("                                       execute - for range-based execution\n");
-        printf(" -l,   --last=<int>                    the last test passing the filters to\n");
-        printf("                                       execute - for range-based execution\n");
-        printf(" -aa,  --abort-after=<int>             stop after <int> failed assertions\n\n");
-        DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
-        printf("Bool options - can be used like flags and true is assumed. Available:\n\n");
-        printf(" -s,   --success=<bool>                include successful assertions in output\n");
-        printf(" -cs,  --case-sensitive=<bool>         filters being treated as case sensitive\n");
-        printf(" -e,   --exit=<bool>                   exits after the tests finish\n");
-        printf(" -no,  --no-overrides=<bool>           disables procedural overrides of options\n");
-        printf(" -nt,  --no-throw=<bool>               skips exceptions-related assert checks\n");
-        printf(" -ne,  --no-exitcode=<bool>            returns (or exits) always with success\n");
-        printf(" -nr,  --no-run=<bool>                 skips all runtime doctest operations\n");
-        printf(" -nc,  --no-colors=<bool>              disables colors in output\n");
-        printf(" -nb,  --no-breaks=<bool>              disables breakpoints in debuggers\n");
-        printf(" -npf, --no-path-filenames=<bool>      only filenames and no paths in output\n\n");
-        // ==================================================================================== << 79
+    void stopWatchdog(Watchdog* watchdog) { delete watchdog; }
 
-        DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
-        printf("for more information visit the project documentation\n\n");
+    void watchTest(ContextState* p, const TestData& data) {
+        p->currentTestTimeout = getTimeout(p, data);
+        if(p->watchdog)
+            p->watchdog->start(p, p->currentTestTimeout);
+    }
+
+    void unwatchTest(ContextState* p) {
+        if(p->watchdog)
+            p->watchdog->stop(p);
     }
 } // namespace detail
 
@@ -2335,12 +7616,11 @@ Context::Context(int argc, const char* const* argv)
 
     parseArgs(argc, argv, true);
 
-    p->help                 = false;
-    p->version              = false;
-    p->count                = false;
-    p->list_test_cases      = false;
-    p->list_test_suites     = false;
-    p->hash_table_histogram = false;
+    p->help             = false;
+    p->version          = false;
+    p->count            = false;
+    p->list_test_cases  = false;
+    p->list_test_suites = false;
     if(parseFlag(argc, argv, "dt-help") || parseFlag(argc, argv, "dt-h") ||
        parseFlag(argc, argv, "dt-?")) {
         p->help = true;
@@ -2362,10 +7642,6 @@ Context::Context(int argc, const char* const* argv)
         p->list_test_suites = true;
         p->exit             = true;
     }
-    if(parseFlag(argc, argv, "dt-hash-table-histogram") || parseFlag(argc, argv, "dt-hth")) {
-        p->hash_table_histogram = true;
-        p->exit                 = true;
-    }
 }
 
 Context::~Context() { delete p; }
@@ -2387,6 +7663,14 @@ void Context::parseArgs(int argc, const char* const* argv, bool withDefaults) {
     parseCommaSepArgs(argc, argv, "dt-tc=",                 p->filters[4]);
     parseCommaSepArgs(argc, argv, "dt-test-case-exclude=",  p->filters[5]);
     parseCommaSepArgs(argc, argv, "dt-tce=",                p->filters[5]);
+    parseCommaSepArgs(argc, argv, "dt-subcase=",            p->filters[6]);
+    parseCommaSepArgs(argc, argv, "dt-sc=",                 p->filters[6]);
+    parseCommaSepArgs(argc, argv, "dt-subcase-exclude=",    p->filters[7]);
+    parseCommaSepArgs(argc, argv, "dt-sce=",                p->filters[7]);
+    parseCommaSepArgs(argc, argv, "dt-reporters=",          p->reporter_names);
+    parseCommaSepArgs(argc, argv, "dt-r=",                  p->reporter_names);
+    parseCommaSepArgs(argc, argv, "dt-perf-counters=",      p->perf_counter_names);
+    parseCommaSepArgs(argc, argv, "dt-pc=",                 p->perf_counter_names);
     // clang-format on
 
     int    intRes = 0;
@@ -2422,6 +7706,20 @@ void Context::parseArgs(int argc, const char* const* argv, bool withDefaults) {
     DOCTEST_PARSE_INT_OPTION(dt-last, dt-l, last, 0);
 
     DOCTEST_PARSE_INT_OPTION(dt-abort-after, dt-aa, abort_after, 0);
+    DOCTEST_PARSE_INT_OPTION(dt-timeout, dt-to, timeout, 0);
+    DOCTEST_PARSE_INT_OPTION(dt-jobs, dt-j, jobs, 1);
+    DOCTEST_PARSE_INT_OPTION(dt-workers, dt-w, workers, 1);
+    DOCTEST_PARSE_STR_OPTION(dt-durations-file, dt-df, durations_file, "");
+    DOCTEST_PARSE_STR_OPTION(dt-isolate, dt-i, isolate, "");
+    DOCTEST_PARSE_INT_OPTION(dt-slowest, dt-sl, slowest, 10);
+    DOCTEST_PARSE_INT_OPTION(dt-benchmark-samples, dt-bs, benchmark_samples, 10);
+    DOCTEST_PARSE_INT_OPTION(dt-benchmark-time, dt-bt, benchmark_time, 10);
+    DOCTEST_PARSE_STR_OPTION(dt-benchmark-out, dt-bo, benchmark_out, "");
+    DOCTEST_PARSE_STR_OPTION(dt-benchmark-baseline, dt-bb, benchmark_baseline, "");
+    DOCTEST_PARSE_INT_OPTION(dt-benchmark-threshold, dt-bth, benchmark_threshold, 10);
+    DOCTEST_PARSE_INT_OPTION(dt-benchmark-confidence, dt-bc, benchmark_confidence, 95);
+    DOCTEST_PARSE_STR_OPTION(dt-out, dt-o, out, "");
+    DOCTEST_PARSE_STR_OPTION(dt-decode-log, dt-dl, decode_log, "");
 
     DOCTEST_PARSE_AS_BOOL_OR_FLAG(dt-success, dt-s, success, 0);
     DOCTEST_PARSE_AS_BOOL_OR_FLAG(dt-case-sensitive, dt-cs, case_sensitive, 0);
@@ -2433,6 +7731,11 @@ void Context::parseArgs(int argc, const char* const* argv, bool withDefaults) {
     DOCTEST_PARSE_AS_BOOL_OR_FLAG(dt-no-colors, dt-nc, no_colors, 0);
     DOCTEST_PARSE_AS_BOOL_OR_FLAG(dt-no-breaks, dt-nb, no_breaks, 0);
     DOCTEST_PARSE_AS_BOOL_OR_FLAG(dt-no-path-filenames, dt-npf, no_path_in_filenames, 0);
+    DOCTEST_PARSE_AS_BOOL_OR_FLAG(dt-async-reporters, dt-ar, async_reporters, 0);
+    DOCTEST_PARSE_AS_BOOL_OR_FLAG(dt-durations, dt-d, durations, 0);
+    DOCTEST_PARSE_AS_BOOL_OR_FLAG(dt-allocations, dt-al, allocations, 0);
+    DOCTEST_PARSE_AS_BOOL_OR_FLAG(dt-fork-subcases, dt-fs, fork_subcases, 0);
+    DOCTEST_PARSE_AS_BOOL_OR_FLAG(dt-parallel-subcases, dt-ps, parallel_subcases, 0);
 // clang-format on
 
 #undef DOCTEST_PARSE_STR_OPTION
@@ -2459,6 +7762,8 @@ void Context::setOption(const char* option, const char* value) {
     }
 }
 
+void Context::addReporter(IReporter* reporter) { p->addedReporters.push_back(reporter); }
+
 // users should query this in their main() and exit the program if true
 bool Context::shouldExit() { return p->exit; }
 
@@ -2469,6 +7774,16 @@ int Context::run() {
     getContextState() = p;
     p->resetRunData();
 
+    // the terminal is queried once here instead of for each colored piece of output
+    p->useColors = !p->no_colors;
+#ifdef DOCTEST_CONFIG_COLORS_ANSI
+    p->useColors = p->useColors && isatty(STDOUT_FILENO);
+#endif // DOCTEST_CONFIG_COLORS_ANSI
+
+    // the buffered output is flushed when returning from here - and a test which crashes is
+    // reported before the program dies
+    CrashHandler crashHandler;
+
     // handle version, help and no_run
     if(p->no_run || p->version || p->help) {
         if(p->version)
@@ -2481,46 +7796,31 @@ int Context::run() {
 
     printVersion();
     DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
-    printf("run with \"-dt-help\" for options\n");
+    writeOutput("run with \"-dt-help\" for options\n");
 
-    unsigned                         i       = 0; // counter used for loops - here for VC6
-    const Vector<Vector<TestData> >& buckets = getRegisteredTests().getBuckets();
+    unsigned i = 0; // counter used for loops - here for VC6
+
+    // the tests aren't executed when decoding a binary log
+    bool isDecode = p->decode_log.size() > 0;
 
     Vector<const TestData*> testArray;
-    for(i = 0; i < buckets.size(); i++)
-        for(unsigned k = 0; k < buckets[i].size(); k++)
-            testArray.push_back(&buckets[i][k]);
-
-    if(p->hash_table_histogram) {
-        // find the most full bucket
-        unsigned maxInBucket = 1;
-        for(i = 0; i < buckets.size(); i++)
-            if(buckets[i].size() > maxInBucket)
-                maxInBucket = buckets[i].size();
-
-        // print a prettified histogram
-        DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
-        printf("hash table bucket histogram\n");
-        printf("============================================================\n");
-        printf("#bucket     |count| relative count\n");
-        printf("============================================================\n");
-        for(i = 0; i < buckets.size(); i++) {
-            printf("bucket %4d |%4d |", static_cast<int>(i), buckets[i].size());
-
-            float ratio = static_cast<float>(buckets[i].size()) / static_cast<float>(maxInBucket);
-            unsigned numStars = static_cast<unsigned>(ratio * 41);
-            for(unsigned k = 0; k < numStars; ++k)
-                printf("*");
-            printf("\n");
-        }
-        printf("\n");
-        return EXIT_SUCCESS;
-    }
+    for(const TestData* curr = getRegisteredTests(); curr && !isDecode; curr = curr->m_next)
+        testArray.push_back(curr);
 
-    // sort the collected records
-    if(p->order_by.compare("file", true) == 0) {
+    // remove the duplicates (tests in headers get registered once for each translation unit)
+    // - after sorting by file/line they are next to each other
+    if(testArray.size() > 0) {
         qsort(testArray.data(), testArray.size(), sizeof(TestData*), fileOrderComparator);
-    } else if(p->order_by.compare("suite", true) == 0) {
+        unsigned numUnique = 1;
+        for(i = 1; i < testArray.size(); i++)
+            if(fileOrderComparator(&testArray[i], &testArray[numUnique - 1]) != 0)
+                testArray[numUnique++] = testArray[i];
+        while(testArray.size() > numUnique)
+            testArray.pop_back();
+    }
+
+    // sort the collected records (they are already sorted by file)
+    if(p->order_by.compare("suite", true) == 0) {
         qsort(testArray.data(), testArray.size(), sizeof(TestData*), suiteOrderComparator);
     } else if(p->order_by.compare("name", true) == 0) {
         qsort(testArray.data(), testArray.size(), sizeof(TestData*), nameOrderComparator);
@@ -2541,31 +7841,113 @@ int Context::run() {
 
     if(p->list_test_cases) {
         DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
-        printf("listing all test case names\n");
+        writeOutput("listing all test case names\n");
     }
 
     HashTable<String> testSuitesPassingFilters(100);
     if(p->list_test_suites) {
         DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
-        printf("listing all test suites\n");
+        writeOutput("listing all test suites\n");
+    }
+
+    bool isQuery = p->count || p->list_test_cases || p->list_test_suites;
+
+    // the benchmarks are compared with the baseline by the threads/processes executing them - a
+    // baseline which can't be read is an error and not an empty one (which would pass everything)
+    String                    baselineContents;
+    Vector<RecordedBenchmark> baseline;
+    if(p->benchmark_baseline.size() > 0 && !isQuery) {
+        if(!readBenchmarksFile(p->benchmark_baseline, baselineContents, baseline)) {
+            DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
+            writeOutput((String("cannot read \"") + p->benchmark_baseline + "\"\n").c_str());
+            flushOutput(true);
+            return p->no_exitcode ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        p->benchmarkBaseline = &baseline;
+    }
+
+    // the events of the run go to the selected reporters and the ones added by the user
+    ConsoleReporter console;
+    JUnitReporter*  junit   = 0;
+    BinlogReporter* binlog  = 0;
+    FILE*           outFile = 0;
+    Reporters       reporters;
+    if(p->reporter_names.size() == 0 || isReporterSelected(p, "console"))
+        reporters.all.push_back(&console);
+    if(p->out.size() > 0 && !isQuery &&
+       (isReporterSelected(p, "junit") || isReporterSelected(p, "binlog"))) {
+        outFile = fopen(p->out.c_str(), "wb");
+        // nothing is executed if the results can't go where they were asked to
+        if(!outFile) {
+            DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
+            writeOutput((String("cannot open \"") + p->out + "\" for writing\n").c_str());
+            flushOutput(true);
+            return p->no_exitcode ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
     }
+    if(isReporterSelected(p, "junit") && !isQuery) {
+        junit = new JUnitReporter(outFile);
+        reporters.all.push_back(junit);
+    }
+    if(isReporterSelected(p, "binlog") && !isQuery) {
+        binlog = new BinlogReporter(outFile);
+        reporters.all.push_back(binlog);
+    }
+    // the perf counters are opened once here so the ones which aren't available are reported once
+    p->perfCounters = isQuery ? 0 : getPerfCounters(p->perf_counter_names, !isDecode);
+    TestStatsReporter stats(p->durations, p->allocations, p->perfCounters,
+                            p->slowest > 0 ? static_cast<unsigned>(p->slowest) : 0);
+    if(p->durations || p->allocations || p->perfCounters)
+        reporters.all.push_back(&stats);
+    BenchmarkOutReporter benchmarkOut(p->benchmark_out);
+    if(p->benchmark_out.size() > 0 && !isQuery)
+        reporters.all.push_back(&benchmarkOut);
+    for(i = 0; i < p->addedReporters.size(); ++i)
+        reporters.all.push_back(p->addedReporters[i]);
+    p->reporters = &reporters;
+
+    // not when decoding a log - the strings from it are freed before the thread would be done
+    AsyncReporting* async = 0;
+    if(p->async_reporters && !isQuery && !isDecode)
+        async = new AsyncReporting(reporters, p);
+
+    // interrupts the tests which run over their time limit
+    p->watchdog = isQuery ? 0 : startWatchdog(p, testArray);
 
     unsigned numTestsPassingFilters = 0;
     unsigned numFailed              = 0;
+
+    Vector<const TestData*> testsForWorkers; // used only with --dt-jobs and --dt-workers
+
+    // with --dt-isolate=fork the tests are executed by worker processes even without --dt-workers
+#ifdef DOCTEST_PLATFORM_WINDOWS
+    bool inProcesses = false;
+#else  // DOCTEST_PLATFORM_WINDOWS
+    bool inProcesses = p->workers > 1 || isolatesTests(p);
+#endif // DOCTEST_PLATFORM_WINDOWS
+
+    // the filters are compiled once for all tests
+    Filter fileFilter(p->filters[0], p->case_sensitive, true);
+    Filter fileExcludeFilter(p->filters[1], p->case_sensitive, false);
+    Filter suiteFilter(p->filters[2], p->case_sensitive, true);
+    Filter suiteExcludeFilter(p->filters[3], p->case_sensitive, false);
+    Filter nameFilter(p->filters[4], p->case_sensitive, true);
+    Filter nameExcludeFilter(p->filters[5], p->case_sensitive, false);
+
     // invoke the registered functions if they match the filter criteria (or just count them)
     for(i = 0; i < testArray.size(); i++) {
         const TestData& data = *testArray[i];
-        if(!matchesAny(data.m_file, p->filters[0], 1, p->case_sensitive))
+        if(!fileFilter.matchesCached(data.m_file))
             continue;
-        if(matchesAny(data.m_file, p->filters[1], 0, p->case_sensitive))
+        if(fileExcludeFilter.matchesCached(data.m_file))
             continue;
-        if(!matchesAny(data.m_suite, p->filters[2], 1, p->case_sensitive))
+        if(!suiteFilter.matchesCached(data.m_suite))
             continue;
-        if(matchesAny(data.m_suite, p->filters[3], 0, p->case_sensitive))
+        if(suiteExcludeFilter.matchesCached(data.m_suite))
             continue;
-        if(!matchesAny(data.m_name, p->filters[4], 1, p->case_sensitive))
+        if(!nameFilter.matches(data.m_name))
             continue;
-        if(matchesAny(data.m_name, p->filters[5], 0, p->case_sensitive))
+        if(nameExcludeFilter.matches(data.m_name))
             continue;
 
         numTestsPassingFilters++;
@@ -2576,14 +7958,16 @@ int Context::run() {
 
         // print the name of the test and don't execute it
         if(p->list_test_cases) {
-            printf("%s\n", data.m_name);
+            writeOutput(data.m_name);
+            writeOutput("\n");
             continue;
         }
 
         // print the name of the test suite if not done already and don't execute it
         if(p->list_test_suites) {
             if(!testSuitesPassingFilters.has(data.m_suite)) {
-                printf("%s\n", data.m_suite);
+                writeOutput(data.m_suite);
+                writeOutput("\n");
                 testSuitesPassingFilters.insert(data.m_suite);
             }
             continue;
@@ -2594,48 +7978,23 @@ int Context::run() {
            (p->first > numTestsPassingFilters))
             continue;
 
+        // leave the execution to the worker threads/processes
+        if(p->jobs > 1 || p->workers > 1 || inProcesses) {
+            testsForWorkers.push_back(&data);
+            continue;
+        }
+
         // execute the test if it passes all the filtering
         {
 #ifdef _MSC_VER
 //__try {
 #endif // _MSC_VER
 
-            p->currentTest = &data;
-
-            // if logging successful tests - force the start log
-            p->hasLoggedCurrentTestStart = false;
-            if(p->success)
-                DOCTEST_LOG_START();
-
-            unsigned didFail = 0;
-            p->subcasesPassed.clear();
-            do {
-                // reset the assertion state
-                p->numAssertionsForCurrentTestcase       = 0;
-                p->numFailedAssertionsForCurrentTestcase = 0;
-
-                // reset some of the fields for subcases (except for the set of fully passed ones)
-                p->subcasesHasSkipped   = false;
-                p->subcasesCurrentLevel = 0;
-                p->subcasesEnteredLevels.clear();
-
-                // execute the test
-                didFail += callTestFunc(data.m_f);
-                p->numAssertions += p->numAssertionsForCurrentTestcase;
-
-                // exit this loop if enough assertions have failed
-                if(p->abort_after > 0 && p->numFailedAssertions >= p->abort_after)
-                    p->subcasesHasSkipped = false;
-
-                // if the start has been logged
-                if(p->hasLoggedCurrentTestStart)
-                    logTestEnd();
-                p->hasLoggedCurrentTestStart = false;
-
-            } while(p->subcasesHasSkipped == true);
-
-            if(didFail > 0)
+            p->numTestCasesExecuted++;
+            if(runTestCase(p, data)) {
                 numFailed++;
+                p->numFailedTestCases++;
+            }
 
             // stop executing tests if enough assertions have failed
             if(p->abort_after > 0 && p->numFailedAssertions >= p->abort_after)
@@ -2650,48 +8009,111 @@ int Context::run() {
         }
     }
 
-    DOCTEST_PRINTF_COLORED(getSeparator(), Color::Yellow);
-    if(p->count || p->list_test_cases || p->list_test_suites) {
-        DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
-        printf("number of tests passing the current filters: %d\n", numTestsPassingFilters);
-    } else {
-        char buff[DOCTEST_SNPRINTF_BUFFER_LENGTH];
-
-        DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
+    if(testsForWorkers.size() > 0) {
+        // the durations from a previous run are used for starting the longest tests first
+        String                   durationsContents;
+        Vector<RecordedDuration> recorded;
+        if(p->durations_file.size() > 0)
+            readDurationsFile(p->durations_file, durationsContents, recorded);
+        Vector<double> estimates = getEstimatedDurations(testsForWorkers, recorded);
+
+        // what has been printed so far should come before the outputs of the workers
+        flushOutput(true);
+
+        OrderedResults results(testsForWorkers.size());
+#ifndef DOCTEST_PLATFORM_WINDOWS
+        if(inProcesses)
+            runTestsInProcesses(p, testsForWorkers, estimates, results);
+        else
+#endif // DOCTEST_PLATFORM_WINDOWS
+            runTestsInParallel(p, testsForWorkers, estimates, results);
+        mergeResults(p, results, testsForWorkers.size(), numTestsPassingFilters, numFailed);
 
-        DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), "test cases: %4d", numTestsPassingFilters);
-        DOCTEST_PRINTF_COLORED(buff, Color::None);
-        DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), " | ");
-        DOCTEST_PRINTF_COLORED(buff, Color::None);
-        DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), "%4d passed",
-                         numTestsPassingFilters - numFailed);
-        DOCTEST_PRINTF_COLORED(buff, Color::Green);
-        DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), " | ");
-        DOCTEST_PRINTF_COLORED(buff, Color::None);
-        DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), "%4d failed\n", numFailed);
-        DOCTEST_PRINTF_COLORED(buff, Color::Red);
+        if(p->durations_file.size() > 0)
+            writeDurationsFile(p->durations_file, testsForWorkers, results, recorded);
+    }
 
+    if(isQuery) {
+        char buff[DOCTEST_SNPRINTF_BUFFER_LENGTH];
+        DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff),
+                         "number of tests passing the current filters: %d\n", numTestsPassingFilters);
+        DOCTEST_PRINTF_COLORED(getSeparator(), Color::Yellow);
         DOCTEST_PRINTF_COLORED("[doctest] ", Color::Cyan);
-
-        DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), "assertions: %4d", p->numAssertions);
-        DOCTEST_PRINTF_COLORED(buff, Color::None);
-        DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), " | ");
-        DOCTEST_PRINTF_COLORED(buff, Color::None);
-        DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), "%4d passed",
-                         p->numAssertions - p->numFailedAssertions);
-        DOCTEST_PRINTF_COLORED(buff, Color::Green);
-        DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), " | ");
-        DOCTEST_PRINTF_COLORED(buff, Color::None);
-        DOCTEST_SNPRINTF(buff, DOCTEST_COUNTOF(buff), "%4d failed\n", p->numFailedAssertions);
-        DOCTEST_PRINTF_COLORED(buff, Color::Red);
+        writeOutput(buff);
+    } else if(isDecode) {
+        numFailed = decodeLog(p);
+    } else {
+        ReporterEvent e                  = makeEvent(reporterEvent::runEnd);
+        e.runStats.m_numTestCases        = numTestsPassingFilters;
+        e.runStats.m_numFailedTestCases  = numFailed;
+        e.runStats.m_numAssertions       = p->numAssertions;
+        e.runStats.m_numFailedAssertions = p->numFailedAssertions;
+        reportEvent(e);
     }
 
+    stopWatchdog(p->watchdog);
+    p->watchdog = 0;
+
+    // waits for the reporters to process everything
+    delete async;
+    p->reporters         = 0;
+    p->benchmarkBaseline = 0;
+    delete junit;
+    delete binlog;
+    if(outFile)
+        fclose(outFile);
+
     if(numFailed && !p->no_exitcode)
         return EXIT_FAILURE;
     return EXIT_SUCCESS;
 }
 } // namespace doctest
 
+// replacements of the global operator new and delete which count the allocations of the tests
+#if defined(DOCTEST_CONFIG_TRACK_ALLOCATIONS)
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1900)
+#define DOCTEST_THROW_BAD_ALLOC
+#define DOCTEST_NOEXCEPT noexcept
+#else // C++11
+#define DOCTEST_THROW_BAD_ALLOC throw(std::bad_alloc)
+#define DOCTEST_NOEXCEPT throw()
+#endif // C++11
+
+void* operator new(size_t size) DOCTEST_THROW_BAD_ALLOC {
+    void* ptr = doctest::detail::allocate(size);
+    if(!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+void* operator new[](size_t size) DOCTEST_THROW_BAD_ALLOC {
+    void* ptr = doctest::detail::allocate(size);
+    if(!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+void* operator new(size_t size, const std::nothrow_t&) DOCTEST_NOEXCEPT {
+    return doctest::detail::allocate(size);
+}
+void* operator new[](size_t size, const std::nothrow_t&) DOCTEST_NOEXCEPT {
+    return doctest::detail::allocate(size);
+}
+void operator delete(void* ptr) DOCTEST_NOEXCEPT { doctest::detail::deallocate(ptr); }
+void operator delete[](void* ptr) DOCTEST_NOEXCEPT { doctest::detail::deallocate(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) DOCTEST_NOEXCEPT {
+    doctest::detail::deallocate(ptr);
+}
+void operator delete[](void* ptr, const std::nothrow_t&) DOCTEST_NOEXCEPT {
+    doctest::detail::deallocate(ptr);
+}
+#if defined(__cpp_sized_deallocation)
+void operator delete(void* ptr, size_t) DOCTEST_NOEXCEPT { doctest::detail::deallocate(ptr); }
+void operator delete[](void* ptr, size_t) DOCTEST_NOEXCEPT { doctest::detail::deallocate(ptr); }
+#endif // __cpp_sized_deallocation
+
+#undef DOCTEST_THROW_BAD_ALLOC
+#undef DOCTEST_NOEXCEPT
+#endif // DOCTEST_CONFIG_TRACK_ALLOCATIONS
+
 #endif // DOCTEST_CONFIG_DISABLE
 #endif // DOCTEST_LIBRARY_IMPLEMENTATION
 #endif // DOCTEST_CONFIG_IMPLEMENT
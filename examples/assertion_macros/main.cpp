@@ -46,3 +46,21 @@ TEST_CASE("exceptions-related macros") {
 
     REQUIRE_NOTHROW(throws(true));
 }
+
+TEST_CASE("binary and unary macros") {
+    int a = 5;
+    int b = 7;
+
+    CHECK_EQ(a, b);
+    CHECK_NE(a, b);
+    CHECK_LT(a, b);
+    CHECK_GE(a, b);
+    CHECK_UNARY(a == b);
+    CHECK_UNARY_FALSE(a == b);
+    CHECK_EQ(throws(true), 42);
+
+    FAST_CHECK_GT(a, b);
+    FAST_CHECK_LE(a, b);
+    FAST_CHECK_UNARY(a);
+    FAST_REQUIRE_UNARY_FALSE(a);
+}
@@ -0,0 +1,53 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <csignal>
+#include <cstdlib>
+
+// the test cases here crash, exit or hang - so they are executed only in processes of their own
+// (with --dt-workers or --dt-isolate) where the run goes on after them
+
+static int counter = 0;
+
+static volatile bool stopRecursion = false;
+
+static int recurse(int depth) {
+    volatile char buff[1024];
+    buff[0] = static_cast<char>(depth);
+    if(stopRecursion)
+        return 0;
+    return recurse(depth + 1) + buff[0];
+}
+
+TEST_CASE("passing") { CHECK(true); }
+
+TEST_CASE("crashing in a subcase") {
+    CHECK(1 == 1);
+    SUBCASE("first") { CHECK(2 == 2); }
+    SUBCASE("second") {
+        CHECK(2 == 2);
+        raise(SIGSEGV);
+    }
+}
+
+// reported even though the signal handler can't use the stack of the test
+TEST_CASE("overflowing the stack") { CHECK(recurse(0) == 0); }
+
+TEST_CASE("exiting") {
+    CHECK(true);
+    exit(3);
+}
+
+TEST_CASE_TIMEOUT("hanging", 0.5) {
+    CHECK(true);
+    for(volatile int i = 0; i >= 0; i = 0)
+        ;
+}
+
+// the next test case sees this change only if it is executed in the same process
+TEST_CASE("changing global state") {
+    counter = 5;
+    CHECK(counter == 5);
+}
+
+TEST_CASE("after the others") { CHECK(counter == 0); }
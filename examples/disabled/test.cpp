@@ -34,6 +34,10 @@ TEST_SUITE("the testsuite!");
     REQUIRE_THROWS_AS(throws(), char);                                                             \
     CHECK_NOTHROW(nothrows());                                                                     \
     REQUIRE_NOTHROW(nothrows());                                                                   \
+    CHECK_EQ(1, 0);                                                                                \
+    FAST_REQUIRE_NE(1, 1);                                                                         \
+    CHECK_UNARY(0);                                                                                \
+    FAST_CHECK_UNARY_FALSE(1);                                                                     \
     SUBCASE("") {}
 
 // in a separate function because the TEST_CASE() macro will expand to an uninstantiated template
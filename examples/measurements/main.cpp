@@ -0,0 +1,212 @@
+#define DOCTEST_CONFIG_IMPLEMENT
+#define DOCTEST_CONFIG_TRACK_ALLOCATIONS
+#include "doctest.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <vector>
+
+// the measurements differ between runs so the program executes itself (with "child" as the first
+// argument) for each set of options and prints the output of that with the numbers masked
+
+static std::string readFile(const char* path) {
+    std::string contents;
+    if(FILE* f = fopen(path, "rb")) {
+        char   buff[1024];
+        size_t num;
+        while((num = fread(buff, 1, sizeof(buff), f)) > 0)
+            contents.append(buff, num);
+        fclose(f);
+    }
+    return contents;
+}
+
+static void writeFile(const char* path, const std::string& contents) {
+    if(FILE* f = fopen(path, "wb")) {
+        fwrite(contents.data(), 1, contents.size(), f);
+        fclose(f);
+    }
+}
+
+static bool isUnit(const std::string& token) {
+    return token == "s" || token == "ms" || token == "us" || token == "ns";
+}
+
+// each number with a fraction (and the unit after it) and each calibrated number of iterations
+// becomes a '#' and the spaces between the words are collapsed (the widths of the columns depend
+// on the numbers) - not the version though
+static std::string masked(const std::string& line) {
+    std::vector<std::string> tokens;
+    for(size_t pos = 0; pos < line.size();) {
+        size_t end = line.find(' ', pos);
+        if(end == std::string::npos)
+            end = line.size();
+        if(end > pos)
+            tokens.push_back(line.substr(pos, end - pos));
+        pos = end + 1;
+    }
+
+    size_t      indent = line.find_first_not_of(' ');
+    std::string res(indent == std::string::npos ? 0 : indent, ' ');
+    bool        wasMasked = false;
+    for(size_t i = 0; i < tokens.size(); ++i) {
+        std::string token = tokens[i];
+        if(wasMasked && isUnit(token))
+            continue;
+        size_t dot = token.find('.');
+        wasMasked  = dot != std::string::npos && dot > 0 && isdigit(token[dot - 1]) &&
+                    token.find('.', dot + 1) == std::string::npos;
+        if(i + 1 < tokens.size() && tokens[i + 1] == "iterations" &&
+           token.find_first_not_of("0123456789") == std::string::npos)
+            token = "#";
+        if(wasMasked) {
+            size_t start = token.find_last_not_of("+-0123456789", dot - 1);
+            start        = start == std::string::npos ? 0 : start + 1;
+            size_t end   = token.find_first_not_of("0123456789", dot + 1);
+            end          = end == std::string::npos ? token.size() : end;
+            token.replace(start, end - start, "#");
+        }
+        res += (i > 0 ? " " : "") + token;
+    }
+    return res;
+}
+
+static int run(const char* self, const std::string& options) {
+    std::string command = std::string("\"") + self + "\" child " + options + " > output.txt";
+    int         res     = system(command.c_str());
+
+    std::string output = readFile("output.txt");
+    for(size_t pos = 0; pos < output.size();) {
+        size_t end = output.find('\n', pos);
+        if(end == std::string::npos)
+            end = output.size();
+        printf("%s\n", masked(output.substr(pos, end - pos)).c_str());
+        pos = end + 1;
+    }
+    fflush(stdout);
+    return res;
+}
+
+int main(int argc, char** argv) {
+    if(argc > 1 && std::string(argv[1]) == "child") {
+        doctest::Context context(argc, argv);
+        return context.run();
+    }
+
+    // the options of the test (for the output) are passed on
+    std::string options;
+    for(int i = 1; i < argc; ++i)
+        options += std::string(" ") + argv[i];
+
+    int res = 0;
+
+    // a line for each test case (and each execution of one with subcases) and the slowest ones
+    res += run(argv[0], "--dt-durations=1 --dt-slowest=2 --dt-test-suite=durations" + options);
+
+    // the statistics of the samples of each benchmark - and with no samples the bodies are only
+    // executed once (for checking that the code in them works)
+    res += run(argv[0], "-bs=3 -bt=1 --dt-test-suite=benchmarks" + options);
+    res += run(argv[0], "-bs=0 --dt-test-suite=benchmarks" + options);
+
+    // a baseline in which "push_back" is impossibly fast and "sum" is very slow - so only the
+    // first one fails (with a confidence of 50% any mean over the limit fails - however noisy)
+    writeFile("baseline.txt", std::string("1e-15 0 10\t") + __FILE__ + "\tvector\tpush_back\n" +
+                                      "1 0 10\t" + __FILE__ + "\tvector\tsum\n");
+    res += run(argv[0], "-bs=3 -bt=1 -bb=baseline.txt -bc=50 --dt-test-suite=benchmarks" + options);
+
+    // the results are recorded and compared with (with a threshold which can't be reached)
+    remove("recorded.txt");
+    res += run(argv[0], "-bs=3 -bt=1 -bo=recorded.txt --dt-test-suite=benchmarks" + options);
+    res += run(argv[0], "-bs=3 -bt=1 -bb=recorded.txt -bth=1000000 -s --dt-test-suite=benchmarks" +
+                                options);
+
+    // a baseline which can't be read is an error
+    res += run(argv[0], "-bb=missing.txt --dt-test-suite=benchmarks" + options);
+
+    // the allocations of the test cases (and the executions of the one with subcases) and the
+    // asserts for the allocations of blocks
+    res += run(argv[0], "--dt-allocations=1 --dt-test-suite=allocations" + options);
+
+    // the perf counters depend on the machine - only an event which doesn't exist is reported the
+    // same way everywhere (and the tests are executed without counting it)
+    res += run(argv[0], "--dt-perf-counters=bogus --dt-test-case=without*" + options);
+
+    return res;
+}
+
+// keeps the CPU busy for the given number of milliseconds (of CPU time)
+static void busy(int milliseconds) {
+    clock_t start = clock();
+    while((clock() - start) * 1000 < clock_t(milliseconds) * CLOCKS_PER_SEC)
+        ;
+}
+
+TEST_SUITE("durations");
+
+TEST_CASE("quick") { CHECK(true); }
+
+TEST_CASE("slow") { busy(20); }
+
+TEST_CASE("slower with subcases") {
+    busy(100);
+    SUBCASE("one") { busy(100); }
+    SUBCASE("two") { busy(150); }
+}
+
+TEST_SUITE_END();
+
+TEST_SUITE("benchmarks");
+
+TEST_CASE("vector") {
+    std::vector<int> v;
+    BENCHMARK("push_back") {
+        v.clear();
+        for(int i = 0; i < 16; ++i)
+            v.push_back(i);
+        doctest::doNotOptimize(v.data());
+    }
+    CHECK(v.size() == 16u);
+
+    BENCHMARK("sum") {
+        int sum = 0;
+        for(size_t i = 0; i < v.size(); ++i)
+            sum += v[i];
+        doctest::doNotOptimize(sum);
+    }
+}
+
+TEST_SUITE_END();
+
+TEST_SUITE("allocations");
+
+TEST_CASE("without allocations") {
+    int a = 5;
+    CHECK_NO_ALLOCATIONS { doctest::doNotOptimize(a); }
+}
+
+TEST_CASE("with allocations") {
+    delete[] new char[100];
+    CHECK_MAX_ALLOCATIONS(2) {
+        delete new int(1);
+        delete new int(2);
+    }
+    CHECK_NO_ALLOCATIONS { delete new int(3); }
+    CHECK_MAX_ALLOCATIONS(1) {
+        char* first  = new char[10];
+        char* second = new char[20];
+        delete[] first;
+        delete[] second;
+    }
+}
+
+TEST_CASE("with allocations in subcases") {
+    char* shared = new char[50];
+    SUBCASE("one") { delete[] new char[10]; }
+    SUBCASE("two") {}
+    delete[] shared;
+}
+
+TEST_SUITE_END();
@@ -1 +1 @@
-#include "doctest.h"
+#include "hdr.h"
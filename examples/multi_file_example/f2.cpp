@@ -1 +1,10 @@
-#include "doctest.h"
+#include "hdr.h"
+
+#include <cstdio>
+
+// the output of doctest is buffered - but it stays in order with what the tests print
+TEST_CASE("printing from a test") {
+    printf("printed before the assert\n");
+    CHECK(1 == 3);
+    printf("printed after the assert\n");
+}
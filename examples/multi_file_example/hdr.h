@@ -2,4 +2,5 @@
 
 #include "doctest.h"
 
-
+// registered by each source file which includes this header - but executed only once
+TEST_CASE("a test in a header") { CHECK(1 == 2); }
@@ -0,0 +1,96 @@
+#define DOCTEST_CONFIG_IMPLEMENT
+#include "doctest.h"
+
+#include <cstdio>
+#include <string>
+
+// the junit and binlog reporters write to files in the working directory which are then read back
+// - the junit one is printed without the durations and the binlog one is decoded (after the run)
+
+static std::string readFile(const char* path) {
+    std::string contents;
+    if(FILE* f = fopen(path, "rb")) {
+        char   buff[1024];
+        size_t num;
+        while((num = fread(buff, 1, sizeof(buff), f)) > 0)
+            contents.append(buff, num);
+        fclose(f);
+    }
+    return contents;
+}
+
+static void writeFile(const char* path, const std::string& contents) {
+    if(FILE* f = fopen(path, "wb")) {
+        fwrite(contents.data(), 1, contents.size(), f);
+        fclose(f);
+    }
+}
+
+// the values of the time attributes differ between runs - so does the padding after the totals
+static std::string withoutTimes(std::string xml) {
+    const std::string attr = "time=\"";
+    for(size_t pos = xml.find(attr); pos != std::string::npos; pos = xml.find(attr, pos)) {
+        pos += attr.size();
+        xml.erase(pos, xml.find('"', pos) - pos);
+        xml.erase(pos + 1, xml.find_first_not_of(' ', pos + 1) - pos - 1);
+    }
+    return xml;
+}
+
+// runs with the options from the command line (the ones for the test output) and the given ones
+static int run(int argc, char** argv, const char* option, const char* value,
+               const char* option2 = 0, const char* value2 = 0) {
+    doctest::Context context(argc, argv);
+    context.setOption(option, value);
+    if(option2)
+        context.setOption(option2, value2);
+    int res = context.run();
+    fflush(stdout);
+    return res;
+}
+
+int main(int argc, char** argv) {
+    int res = 0;
+
+    res += run(argc, argv, "reporters", "junit", "out", "results.xml");
+    printf("%s", withoutTimes(readFile("results.xml")).c_str());
+
+    res += run(argc, argv, "reporters", "binlog", "out", "results.binlog");
+    res += run(argc, argv, "decode-log", "results.binlog");
+    res += run(argc, argv, "decode-log", "results.binlog", "test-case", "*subcases*");
+
+    // the log of a run which didn't get to its end - the last record is cut short
+    std::string log = readFile("results.binlog");
+    writeFile("truncated.binlog", log.substr(0, log.size() - 8));
+    res += run(argc, argv, "decode-log", "truncated.binlog");
+
+    // not a binary log at all
+    res += run(argc, argv, "decode-log", "results.xml");
+
+    // nothing is executed when the output can't be written
+    res += run(argc, argv, "reporters", "junit", "out", "missing/results.xml");
+
+    return res;
+}
+
+TEST_CASE("passing") { CHECK(1 == 1); }
+
+TEST_CASE("failing with <xml> & \"escaping\"") {
+    int a = 4;
+    CHECK(a == 5);
+    CHECK(a < 3);
+}
+
+TEST_SUITE("the suite");
+
+TEST_CASE("with subcases") {
+    SUBCASE("first") { CHECK(1 == 2); }
+    SUBCASE("second") { REQUIRE(2 == 3); }
+}
+
+TEST_SUITE_END();
+
+TEST_CASE("throwing") {
+    CHECK(true);
+    throw 5;
+}
@@ -43,8 +43,10 @@ struct StringMaker<std::list<T> >
 }
 
 // to silence GCC warnings when inheriting from the class MyType which has no virtual destructor
+// and when comparing the floats in it with the == operator
 #if defined(__GNUC__) && !defined(__clang__)
 #pragma GCC diagnostic ignored "-Weffc++"
+#pragma GCC diagnostic ignored "-Wfloat-equal"
 #endif // __GNUC__
 
 template <typename T, typename K>
@@ -90,6 +92,7 @@ TEST_CASE("the only test") {
     MyTypeInherited<int> bla2;
     bla2.one = 5;
     bla2.two = 6.0f;
+    CHECK(bla1 == bla2);
 
     Foo f1;
     Foo f2;
@@ -125,3 +128,27 @@ TEST_CASE("the only test") {
 
     CHECK(lst_1 == lst_2);
 }
+
+TEST_CASE("doctest strings") {
+    // up to 23 characters are stored inline and longer strings on the heap
+    doctest::String inline_max = "12345678901234567890123";
+    doctest::String on_heap    = "123456789012345678901234";
+    CHECK(inline_max.size() == 23u);
+    CHECK(on_heap.size() == 24u);
+
+    doctest::String appended = inline_max;
+    appended += "4";
+    CHECK(appended == on_heap);
+
+    doctest::String chained;
+    for(int i = 0; i < 10; ++i)
+        chained += "abcdef";
+    CHECK(chained.size() == 60u);
+
+    doctest::String assigned = on_heap;
+    assigned                 = "short";
+    CHECK(assigned.size() == 5u);
+    CHECK(assigned == "short");
+
+    CHECK(inline_max == on_heap + chained);
+}
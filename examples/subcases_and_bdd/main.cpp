@@ -105,3 +105,39 @@ TEST_CASE_FIXTURE(TheFixture, "test with a fixture - 2") {
     data *= 2;
     CHECK(data == 85);
 }
+
+// the subcases of a helper are separate paths for each subcase from which the helper is called
+static void checkSign(int value) {
+    SUBCASE("positive") { CHECK(value > 0); }
+    SUBCASE("not negative") { CHECK(value >= 0); }
+}
+
+TEST_CASE("subcases in a helper called from different subcases") {
+    SUBCASE("one") { checkSign(1); }
+    SUBCASE("zero") { checkSign(0); }
+    SUBCASE("minus one") { checkSign(-1); }
+}
+
+// with --dt-fork-subcases the code before the subcases is executed (and its assert counted) once
+TEST_CASE("a failing setup shared by subcases") {
+    cout << endl << "setup" << endl;
+    CHECK(1 == 2);
+    SUBCASE("a") { CHECK(true); }
+    SUBCASE("b") { CHECK(true); }
+}
+
+// a failing REQUIRE (or an exception) ends the test case - the subcases after it aren't entered
+TEST_CASE("subcases after a failing REQUIRE") {
+    SUBCASE("passing") { CHECK(true); }
+    SUBCASE("requiring") {
+        SUBCASE("first") { REQUIRE(1 == 2); }
+        SUBCASE("second") { CHECK(3 == 4); }
+    }
+    SUBCASE("after") { CHECK(5 == 6); }
+}
+
+TEST_CASE("subcases after an exception") {
+    SUBCASE("passing") { CHECK(true); }
+    SUBCASE("throwing") { throws(true); }
+    SUBCASE("after") { CHECK(7 == 8); }
+}
@@ -1,6 +1,30 @@
 #define DOCTEST_CONFIG_IMPLEMENT
 #include "doctest.h"
 
+#include <cstdio>
+
+// a reporter which receives the events of the run along with the default console one
+struct SlowestTestReporter : public doctest::IReporter
+{
+    const char* name;
+    double      duration;
+
+    SlowestTestReporter()
+            : name("")
+            , duration(-1) {}
+
+    void testCaseEnd(const doctest::TestCaseData& tc, const doctest::TestCaseStats& stats) {
+        if(stats.m_duration > duration) {
+            name     = tc.m_name;
+            duration = stats.m_duration;
+        }
+    }
+
+    void runEnd(const doctest::RunStats& stats) {
+        printf("%u test cases executed - the slowest was \"%s\"\n", stats.m_numTestCases, name);
+    }
+};
+
 int main(int argc, char** argv) {
     doctest::Context context(argc, argv); // initialize
 
@@ -10,6 +34,9 @@ int main(int argc, char** argv) {
     context.setOption("abort-after", 5);  // stop test execution after 5 failed assertions
     context.setOption("sort", "name");    // sort the test cases by their name
 
+    SlowestTestReporter reporter;
+    context.addReporter(&reporter); // must outlive the call to run()
+
     int res = context.run(); // run
 
     if(context.shouldExit()) // important - query flags (and --no-run) rely on the user doing this